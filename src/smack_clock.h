@@ -0,0 +1,169 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Clocks.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <vector>
+
+#include "smack_common.h"
+
+namespace smack {
+
+/**
+ * A source for the current time.
+ */
+class Clock {
+public:
+    virtual ~Clock() = default;
+
+    /**
+     * Get the current time.
+     */
+    virtual auto now() const -> TimePoint = 0;
+};
+
+/**
+ * The clock backed by std::chrono::system_clock.
+ */
+class SystemClock final : public Clock {
+public:
+    auto now() const -> TimePoint override
+    {
+        return std::chrono::system_clock::now();
+    }
+
+    /**
+     * Get the shared instance.
+     */
+    static auto instance() -> SystemClock&
+    {
+        static SystemClock result;
+        return result;
+    }
+};
+
+/**
+ * A clock that only moves when it is advanced explicitly.  Listeners,
+ * for example a Scheduler, are advanced in single steps to the times they
+ * requested.  This allows to simulate long periods of time in a
+ * deterministic way.  Note that the clock must not be advanced
+ * concurrently from more than one thread.
+ */
+class VirtualClock final : public Clock {
+public:
+    /**
+     * Receives the time steps of a virtual clock.
+     */
+    class Listener {
+    public:
+        virtual ~Listener() = default;
+
+        /**
+         * Get the next time the listener needs to be stepped.
+         */
+        virtual auto next() -> std::optional<TimePoint> = 0;
+
+        /**
+         * Called when the clock reached the time returned by next().
+         */
+        virtual auto step() -> void = 0;
+    };
+
+private:
+    std::atomic<TimePoint> now_;
+
+    std::vector<Listener*> listeners_;
+
+public:
+    /**
+     * Create an instance.
+     *
+     * @param start The initial time.
+     */
+    explicit VirtualClock(TimePoint start = TimePoint{})
+        : now_{start}
+    {
+    }
+
+    VirtualClock(const VirtualClock&) = delete;
+    VirtualClock& operator=(const VirtualClock&) = delete;
+
+    auto now() const -> TimePoint override
+    {
+        return now_;
+    }
+
+    /**
+     * Register a listener.
+     */
+    auto attach( Listener& listener ) -> void
+    {
+        listeners_.push_back(&listener);
+    }
+
+    /**
+     * Unregister a listener.
+     */
+    auto detach( Listener& listener ) -> void
+    {
+        listeners_.erase(
+            std::remove(listeners_.begin(), listeners_.end(), &listener),
+            listeners_.end());
+    }
+
+    /**
+     * Advance the clock to the passed time.  All listeners that requested
+     * a time up to the passed time are stepped in time order.  Listeners
+     * with the same requested time are stepped in attach order.
+     *
+     * @param target The time to advance to.  If this is in the past,
+     * only pending steps are performed.
+     */
+    auto advanceTo( TimePoint target ) -> void
+    {
+        while (true) {
+            Listener* first = nullptr;
+            TimePoint at;
+
+            for (auto listener : listeners_) {
+                auto next = listener->next();
+                if (next && *next <= target && (first == nullptr || *next < at)) {
+                    first = listener;
+                    at = *next;
+                }
+            }
+
+            if (first == nullptr) {
+                break;
+            }
+
+            if (at > now_.load()) {
+                now_ = at;
+            }
+
+            first->step();
+        }
+
+        if (target > now_.load()) {
+            now_ = target;
+        }
+    }
+
+    /**
+     * Advance the clock by the passed duration, see advanceTo().
+     */
+    auto advance( Duration duration ) -> void
+    {
+        advanceTo(now() + duration);
+    }
+};
+
+} // namespace smack
@@ -10,6 +10,7 @@
 
 #include <chrono>
 #include <functional>
+#include <vector>
 
 namespace smack {
 
@@ -23,6 +24,12 @@ namespace smack {
      */
     using CONSUMER = std::function<void(THUNK)>;
 
+    /**
+     * A consumer of a batch of thunks that became due at the same time.
+     * The consumer may move the thunks out of the passed vector.
+     */
+    using BATCH_CONSUMER = std::function<void(std::vector<THUNK>&&)>;
+
     using Duration =
         std::chrono::milliseconds;
     using TimePoint =
@@ -0,0 +1,298 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Calendar schedules in cron syntax.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#include <cstdlib>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+#include "smack_cron.h"
+#include "smack_util.hpp"
+
+namespace {
+
+using std::string;
+
+/**
+ * Get the days since 1970-01-01 for a date in the proleptic Gregorian
+ * calendar.  See http://howardhinnant.github.io/date_algorithms.html
+ */
+auto daysFromCivil( int y, unsigned m, unsigned d ) -> int64_t
+{
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+/**
+ * The inverse of daysFromCivil().
+ */
+auto civilFromDays( int64_t z, int& y, unsigned& m, unsigned& d ) -> void
+{
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<int>(yoe + era * 400) + (m <= 2);
+}
+
+auto isLeap( int y ) -> bool
+{
+    return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+}
+
+auto daysInMonth( int y, unsigned m ) -> unsigned
+{
+    static const unsigned days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+    return m == 2 && isLeap(y) ? 29 : days[m - 1];
+}
+
+/**
+ * Get the lowest set bit at a position greater or equal than from.
+ *
+ * @return The bit position or -1 if no such bit is set.
+ */
+auto nextBit( uint64_t bits, unsigned from ) -> int
+{
+    if (from >= 64) {
+        return -1;
+    }
+
+    bits &= ~uint64_t{0} << from;
+
+    if (bits == 0) {
+        return -1;
+    }
+
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(bits);
+#elif defined(_MSC_VER) && defined(_WIN64)
+    unsigned long result;
+    _BitScanForward64(&result, bits);
+    return static_cast<int>(result);
+#else
+    int result = 0;
+    while ((bits & 1) == 0) {
+        bits >>= 1;
+        ++result;
+    }
+    return result;
+#endif
+}
+
+auto toNumber( std::string_view in, const string& field ) -> unsigned
+{
+    if (in.empty() || in.size() > 2 || in.find_first_not_of("0123456789") != std::string_view::npos) {
+        throw std::invalid_argument("Invalid cron field: " + field);
+    }
+
+    return static_cast<unsigned>(std::atoi(string{in}.c_str()));
+}
+
+/**
+ * Parse a single cron field into a bit set.
+ *
+ * @param restricted Set to false if the field starts with '*'.
+ */
+auto parseField( const string& field, unsigned min, unsigned max, bool& restricted ) -> uint64_t
+{
+    uint64_t result = 0;
+
+    restricted = field.empty() || field[0] != '*';
+
+    for (const auto& part : smack::split(field, ",")) {
+        std::string_view range{ part };
+        unsigned step = 1;
+
+        if (auto slash = range.find('/'); slash != std::string_view::npos) {
+            step = toNumber(range.substr(slash + 1), field);
+            range = range.substr(0, slash);
+
+            if (step == 0) {
+                throw std::invalid_argument("Invalid cron step: " + field);
+            }
+        }
+
+        unsigned first = min;
+        unsigned last = max;
+
+        if (range != "*") {
+            if (auto dash = range.find('-'); dash != std::string_view::npos) {
+                first = toNumber(range.substr(0, dash), field);
+                last = toNumber(range.substr(dash + 1), field);
+            }
+            else {
+                first = toNumber(range, field);
+                // "a/n" means from a to the maximum.
+                last = step == 1 && part.find('/') == string::npos ? first : max;
+            }
+        }
+
+        if (first < min || last > max || first > last) {
+            throw std::invalid_argument("Cron value out of range: " + field);
+        }
+
+        for (unsigned i = first; i <= last; i += step) {
+            result |= uint64_t{1} << i;
+        }
+    }
+
+    return result;
+}
+
+} // namespace
+
+namespace smack {
+
+CronExpression::CronExpression( const std::string& expression )
+{
+    std::vector<string> fields;
+    for (const auto& field : split(trim(expression), " ")) {
+        if (!field.empty()) {
+            fields.push_back(field);
+        }
+    }
+
+    if (fields.size() != 5) {
+        throw std::invalid_argument("Cron expression needs five fields: " + expression);
+    }
+
+    bool restricted;
+    minutes_ = parseField(fields[0], 0, 59, restricted);
+    hours_ = static_cast<uint32_t>(parseField(fields[1], 0, 23, restricted));
+    daysOfMonth_ = static_cast<uint32_t>(parseField(fields[2], 1, 31, domRestricted_));
+    months_ = static_cast<uint16_t>(parseField(fields[3], 1, 12, restricted));
+    auto dow = parseField(fields[4], 0, 7, dowRestricted_);
+    // Both 0 and 7 are Sunday.
+    daysOfWeek_ = static_cast<uint8_t>((dow | (dow >> 7)) & 0x7f);
+}
+
+auto CronExpression::days( int year, unsigned month ) const -> uint32_t
+{
+    auto count = daysInMonth(year, month);
+    uint32_t inMonth = ((uint32_t{1} << count) - 1) << 1;
+
+    // The days of the week rotated to the days of the month.  Bit 1
+    // is the weekday of the first day of the month.
+    auto firstWeekday = static_cast<unsigned>(
+        ((daysFromCivil(year, month, 1) % 7) + 11) % 7);
+    uint32_t week =
+        ((daysOfWeek_ >> firstWeekday) | (daysOfWeek_ << (7 - firstWeekday))) & 0x7f;
+    uint32_t byWeekday = 0;
+    for (unsigned i = 1; i <= 31; i += 7) {
+        byWeekday |= week << i;
+    }
+
+    uint32_t result;
+    if (domRestricted_ && dowRestricted_) {
+        result = daysOfMonth_ | byWeekday;
+    }
+    else {
+        result = daysOfMonth_ & byWeekday;
+    }
+
+    return result & inMonth;
+}
+
+auto CronExpression::next( TimePoint after ) const -> std::optional<TimePoint>
+{
+    using namespace std::chrono;
+
+    // Start at the minute following the passed time.
+    auto start = floor<minutes>(after) + minutes{1};
+    auto dayCount = floor<duration<int64_t, std::ratio<86400>>>(start).time_since_epoch().count();
+    auto minuteOfDay = static_cast<unsigned>(
+        duration_cast<minutes>(start.time_since_epoch()).count() - dayCount * 1440);
+
+    int year;
+    unsigned month, day;
+    civilFromDays(dayCount, year, month, day);
+    unsigned hour = minuteOfDay / 60;
+    unsigned minute = minuteOfDay % 60;
+
+    auto firstHour = static_cast<unsigned>(nextBit(hours_, 0));
+    auto firstMinute = static_cast<unsigned>(nextBit(minutes_, 0));
+
+    // A day that exists in a selected month is found within the leap
+    // year cycle, otherwise the expression never matches.
+    auto limit = year + 8;
+
+    while (year <= limit) {
+        auto m = nextBit(months_, month);
+        if (m < 0) {
+            ++year;
+            month = static_cast<unsigned>(nextBit(months_, 1));
+            day = 1;
+            hour = firstHour;
+            minute = firstMinute;
+            continue;
+        }
+        if (static_cast<unsigned>(m) != month) {
+            month = static_cast<unsigned>(m);
+            day = 1;
+            hour = firstHour;
+            minute = firstMinute;
+        }
+
+        auto d = nextBit(days(year, month), day);
+        if (d < 0) {
+            if (++month > 12) {
+                ++year;
+                month = 1;
+            }
+            day = 1;
+            hour = firstHour;
+            minute = firstMinute;
+            continue;
+        }
+        if (static_cast<unsigned>(d) != day) {
+            day = static_cast<unsigned>(d);
+            hour = firstHour;
+            minute = firstMinute;
+        }
+
+        auto h = nextBit(hours_, hour);
+        if (h < 0) {
+            ++day;
+            hour = firstHour;
+            minute = firstMinute;
+            continue;
+        }
+        if (static_cast<unsigned>(h) != hour) {
+            hour = static_cast<unsigned>(h);
+            minute = firstMinute;
+        }
+
+        auto mi = nextBit(minutes_, minute);
+        if (mi < 0) {
+            ++hour;
+            minute = firstMinute;
+            continue;
+        }
+
+        return TimePoint{ duration_cast<TimePoint::duration>(
+            minutes{ daysFromCivil(year, month, day) * 1440 + hour * 60 + mi }) };
+    }
+
+    return {};
+}
+
+} // namespace smack
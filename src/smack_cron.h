@@ -0,0 +1,71 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Calendar schedules in cron syntax.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "smack_common.h"
+
+namespace smack {
+
+/**
+ * A calendar schedule in the five field cron syntax
+ * "minute hour day-of-month month day-of-week", for example
+ * "0 2 * * *" for every day at 02:00 or "0/15 * * * *" for every 15
+ * minutes aligned to the hour.  Each field accepts '*', numbers, ranges
+ * "a-b", steps "a/n" and "a-b/n", a '*' followed by a step, and
+ * comma-separated lists of these.
+ * Days of the week are 0 to 7 where both 0 and 7 are Sunday.  If both the
+ * day of month and the day of week are restricted, that is do not start
+ * with '*', a day matching either one is selected, otherwise a day has
+ * to match both, like in the classic cron.
+ *
+ * The expression is parsed once into bit sets.  Times are interpreted
+ * as UTC.
+ */
+class CronExpression {
+    // Bit n is set if the value n is selected.
+    uint64_t minutes_ = 0;
+    uint32_t hours_ = 0;
+    uint32_t daysOfMonth_ = 0;
+    uint16_t months_ = 0;
+    uint8_t daysOfWeek_ = 0;
+
+    // True if the respective field does not start with '*'.
+    bool domRestricted_ = false;
+    bool dowRestricted_ = false;
+
+    /**
+     * Get the selected days of a month as a bit set, bit 1 is the
+     * first day.
+     */
+    auto days( int year, unsigned month ) const -> uint32_t;
+
+public:
+    /**
+     * Create an instance.
+     *
+     * @param expression The cron expression.
+     * @throws std::invalid_argument If the expression is not valid.
+     */
+    explicit CronExpression( const std::string& expression );
+
+    /**
+     * Get the next time that matches the expression.
+     *
+     * @param after The time to start from.  The result is strictly after
+     * this time.
+     * @return The next matching time, at the start of a minute.  Empty if
+     * no such time exists, for example for "0 0 30 2 *".
+     */
+    auto next( TimePoint after ) const -> std::optional<TimePoint>;
+};
+
+} // namespace smack
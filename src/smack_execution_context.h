@@ -0,0 +1,73 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * A per-task execution context.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "smack_common.h"
+
+namespace smack {
+
+/**
+ * A small execution context that travels with a task.  The Scheduler and
+ * the ThreadPool capture the calling thread's context when a task is
+ * submitted and restore it while the task is executed.  This allows
+ * to trace a request across several hops without copying the context
+ * into each lambda.  Copying a context does not allocate.
+ */
+struct ExecutionContext {
+    /**
+     * An id identifying the traced request, zero if not traced.
+     */
+    uint64_t traceId = 0;
+
+    /**
+     * The time by which the traced request should be finished.
+     */
+    TimePoint deadline = TimePoint::max();
+
+    /**
+     * Get the calling thread's current context.
+     */
+    static auto current() -> const ExecutionContext&
+    {
+        return current_;
+    }
+
+    class Scope;
+
+private:
+    static thread_local ExecutionContext current_;
+};
+
+inline thread_local ExecutionContext ExecutionContext::current_;
+
+/**
+ * Sets the calling thread's context for its lifetime and restores the
+ * previous context on destruction.
+ */
+class ExecutionContext::Scope {
+    ExecutionContext previous_;
+
+public:
+    explicit Scope( const ExecutionContext& context )
+        : previous_{ current_ }
+    {
+        current_ = context;
+    }
+
+    ~Scope()
+    {
+        current_ = previous_;
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+};
+
+} // namespace smack
@@ -7,24 +7,311 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <condition_variable>
 #include <stdexcept>
 #include <functional>
+#include <iterator>
+#include <list>
 #include <map>
 #include <mutex>
+#include <optional>
 #include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
+#if defined(SMACK_SCHEDULER_TIMERFD)
+#  include <cerrno>
+#  include <cstdint>
+#  include <ctime>
+#  include <system_error>
+#  include <sys/epoll.h>
+#  include <sys/eventfd.h>
+#  include <sys/timerfd.h>
+#  include <unistd.h>
+#endif
+
+#include "smack_clock.h"
 #include "smack_common.h"
+#include "smack_cron.h"
+#include "smack_execution_context.h"
+#include "smack_util_histogram.hpp"
 
 namespace smack {
 
+namespace internal {
+
 /**
- * A task scheduler.
+ * Lets the scheduler's dispatcher wait for a deadline or a notification.
+ * Based on a condition variable.
+ */
+class ConditionSignal {
+    std::mutex mutex_;
+    std::condition_variable cv_;
+
+public:
+    /**
+     * Wait until the deadline is reached or notify() is called.
+     *
+     * @param deadline The deadline, nullptr to wait for notify() only.
+     * @param mustWait Checked before waiting.  No wait is performed if
+     * this returns false.  A notify() that happens after the check
+     * ends the wait.
+     */
+    template <typename P>
+    auto wait( const TimePoint* deadline, P mustWait ) -> void
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        if (!mustWait()) {
+            return;
+        }
+
+        if (deadline) {
+            cv_.wait_until(lock, *deadline);
+        }
+        else {
+            cv_.wait(lock);
+        }
+    }
+
+    /**
+     * End a running or upcoming wait().
+     */
+    auto notify() -> void
+    {
+        // The dispatcher holds the mutex until it actually waits.
+        std::lock_guard<std::mutex> lock(mutex_);
+        cv_.notify_one();
+    }
+};
+
+#if defined(SMACK_SCHEDULER_TIMERFD)
+
+/**
+ * Lets the scheduler's dispatcher wait for a deadline or a notification.
+ * Based on a Linux timerfd for the deadline and an eventfd for the
+ * notification, both waited for by epoll.  Notifications never block
+ * and the timer is armed with an absolute CLOCK_MONOTONIC time.
+ */
+class TimerfdSignal {
+    int epoll_;
+    int timer_;
+    int event_;
+
+    static auto check( int result, const char* operation ) -> int
+    {
+        if (result < 0) {
+            throw std::system_error(errno, std::generic_category(), operation);
+        }
+
+        return result;
+    }
+
+    /**
+     * Arm the timer for the passed deadline or disarm it.
+     */
+    auto arm( const TimePoint* deadline ) -> void
+    {
+        itimerspec spec{};
+
+        if (deadline) {
+            // The deadline is on the system clock, the timer uses the
+            // monotonic clock that backs std::chrono::steady_clock.
+            auto at = std::chrono::steady_clock::now().time_since_epoch() +
+                (*deadline - std::chrono::system_clock::now());
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(at).count();
+
+            // A zero value would disarm the timer.
+            if (ns <= 0) {
+                ns = 1;
+            }
+
+            spec.it_value.tv_sec = ns / 1'000'000'000;
+            spec.it_value.tv_nsec = ns % 1'000'000'000;
+        }
+
+        check( timerfd_settime(timer_, TFD_TIMER_ABSTIME, &spec, nullptr), "timerfd_settime" );
+    }
+
+    /**
+     * Reset the passed file descriptor's counter.
+     */
+    static auto consume( int fd ) -> void
+    {
+        uint64_t count;
+        // Non-blocking, fails with EAGAIN if nothing is pending.
+        while (read(fd, &count, sizeof count) < 0 && errno == EINTR) {
+        }
+    }
+
+public:
+    TimerfdSignal()
+        : epoll_{ check( epoll_create1(EPOLL_CLOEXEC), "epoll_create1" ) }
+        , timer_{ check( timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC), "timerfd_create" ) }
+        , event_{ check( eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC), "eventfd" ) }
+    {
+        for (int fd : { timer_, event_ }) {
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+            check( epoll_ctl(epoll_, EPOLL_CTL_ADD, fd, &event), "epoll_ctl" );
+        }
+    }
+
+    TimerfdSignal(const TimerfdSignal&) = delete;
+    TimerfdSignal& operator=(const TimerfdSignal&) = delete;
+
+    ~TimerfdSignal()
+    {
+        close(event_);
+        close(timer_);
+        close(epoll_);
+    }
+
+    /**
+     * Wait until the deadline is reached or notify() is called.
+     *
+     * @param deadline The deadline, nullptr to wait for notify() only.
+     * @param mustWait Checked before waiting.  No wait is performed if
+     * this returns false.  A notify() that happens after the check
+     * ends the wait.
+     */
+    template <typename P>
+    auto wait( const TimePoint* deadline, P mustWait ) -> void
+    {
+        if (!mustWait()) {
+            return;
+        }
+
+        arm(deadline);
+
+        epoll_event events[2];
+        int count = epoll_wait(epoll_, events, 2, -1);
+
+        for (int i = 0; i < count; ++i) {
+            consume(events[i].data.fd);
+        }
+    }
+
+    /**
+     * End a running or upcoming wait().
+     */
+    auto notify() -> void
+    {
+        uint64_t one = 1;
+        while (write(event_, &one, sizeof one) < 0 && errno == EINTR) {
+        }
+    }
+};
+
+using SchedulerSignal = TimerfdSignal;
+
+#else
+
+using SchedulerSignal = ConditionSignal;
+
+#endif
+
+} // namespace internal
+
+/**
+ * A task scheduler.  The execution context of the thread that schedules
+ * a task is restored while the task is executed.
  */
-class Scheduler {
+class Scheduler : private VirtualClock::Listener {
+public:
+    /**
+     * The handling of pending tasks on stop.
+     */
+    enum class Drain {
+        // Discard all pending tasks.
+        None,
+        // Execute the tasks that are due until a deadline.
+        UntilDeadline
+    };
+
+    /**
+     * A snapshot of a scheduler's statistics.
+     */
+    struct Statistics {
+        /**
+         * The lateness histogram, that is the number of tasks by the
+         * difference of the time they were passed to the consumer and
+         * their due time.  In microseconds with a relative precision of
+         * 1/32.
+         */
+        util::Histogram::Snapshot latenessHistogram;
+
+        /**
+         * The number of scheduled tasks that are not yet passed to the
+         * consumer.
+         */
+        uint64_t pending;
+
+        /**
+         * The number of tasks passed to the consumer.
+         */
+        uint64_t fired;
+
+        /**
+         * The number of batches passed to the consumer.
+         */
+        uint64_t batches;
+
+        /**
+         * The number of times the dispatcher was woken up by a deadline
+         * or a notification.
+         */
+        uint64_t wakeups;
+
+        /**
+         * The time the dispatcher spent taking submitted and due tasks,
+         * that is the time it delayed the execution of due tasks.
+         */
+        std::chrono::nanoseconds dispatchTime;
+
+        /**
+         * The time the snapshot was taken.
+         */
+        std::chrono::steady_clock::time_point at;
+
+        /**
+         * Get the upper bound of the lateness of the passed fraction of
+         * tasks.
+         *
+         * @param fraction The fraction in the range [0.0, 1.0], for
+         * example 0.99 for the 99th percentile.
+         * @return The upper bound of the lateness bucket that contains
+         * the percentile, see latenessHistogram.  Zero if no tasks were
+         * fired.
+         */
+        auto latenessPercentile( double fraction ) const -> std::chrono::microseconds
+        {
+            return std::chrono::microseconds{ latenessHistogram.percentile(fraction) };
+        }
+
+        /**
+         * Get the number of tasks fired per second since an earlier
+         * snapshot.
+         */
+        auto firesPerSecond( const Statistics& earlier ) const -> double
+        {
+            std::chrono::duration<double> elapsed = at - earlier.at;
+
+            if (elapsed.count() <= 0) {
+                return 0.0;
+            }
+
+            return (fired - earlier.fired) / elapsed.count();
+        }
+    };
 
+private:
     static auto internalConsumer( THUNK thunk ) -> void
     {
         std::thread( [thunk = std::move(thunk)]() {
@@ -32,81 +319,590 @@ class Scheduler {
         }).detach();
     }
 
-    CONSUMER consumer_;
+    /**
+     * Adapts a single task consumer to a batch consumer.
+     */
+    static auto toBatchConsumer( CONSUMER consumer ) -> BATCH_CONSUMER
+    {
+        return [consumer = std::move(consumer)]( std::vector<THUNK>&& batch ) {
+            for ( auto& thunk : batch ) {
+                consumer( std::move(thunk) );
+            }
+        };
+    }
 
     /**
-     * A thread that performs the scheduling.
+     * Executes a batch on the calling thread.
      */
-    std::thread dispatcher_;
+    static auto inlineConsumer( std::vector<THUNK>&& batch ) -> void
+    {
+        for ( auto& thunk : batch ) {
+            thunk();
+        }
+    }
 
-    // The scheduled tasks in sorted order.
-    std::multimap<std::chrono::time_point<std::chrono::system_clock>, THUNK> ptasks_;
+    // The source of the current time.
+    Clock& clock_;
 
-    // Protects ptasks_ and stop_.
-    std::mutex mutex_;
+    BATCH_CONSUMER consumer_;
 
-    // Signals changes in the tasks queue.
-    std::condition_variable cv_;
+    // The driving clock if the scheduler runs on virtual time.
+    VirtualClock* virtualClock_ = nullptr;
+
+    /**
+     * A scheduled task.  The task may be executed at any time between
+     * its due time and its deadline, that is the due time plus the
+     * slack passed when the task was scheduled.
+     */
+    struct Recurring;
+
+    struct Entry {
+        TimePoint due_;
+        THUNK task_;
+        // Set for a cyclic task, task_ is empty then.
+        Recurring* recurring_ = nullptr;
+        // The producer's context, restored when the task is executed.
+        ExecutionContext context_;
+    };
+
+    /**
+     * A task on its way from a producer to the dispatcher.
+     */
+    struct Submission {
+        Submission* next_;
+        TimePoint deadline_;
+        Entry entry_;
+    };
+
+    using TaskMap = std::multimap<TimePoint, Entry>;
+
+    /**
+     * A cyclic or calendar task.  Created once and re-armed in place after
+     * each run, so that a cycle performs no allocation.
+     */
+    struct Recurring {
+        THUNK task_;
+        Duration period_;
+        // Set for calendar tasks, replaces the period.
+        std::optional<CronExpression> cron_;
+        // Holds the task map node while the task is executed.
+        TaskMap::node_type node_;
+        // Passes the task back to the dispatcher after a run.
+        Submission submission_;
+        // The position in cyclic_.
+        std::list<Recurring>::iterator position_;
+        // The context restored for each execution.
+        ExecutionContext context_;
+        // True from the time the dispatcher collects the task until its
+        // run finished.  Protected by cyclicMutex_.
+        bool collected_ = false;
+    };
+
+    /**
+     * The inbox for submitted tasks.  This is a lock-free stack that is
+     * pushed by the producers and emptied in a single step by the
+     * dispatcher.
+     */
+    std::atomic<Submission*> inbox_ = nullptr;
+
+    // The scheduled tasks sorted by their deadline.  Only accessed by
+    // the dispatcher.
+    TaskMap ptasks_;
+
+    // The tasks that are due in a single wake-up.  A member to reuse
+    // its capacity.
+    std::vector<THUNK> batch_;
+
+    // The cyclic and calendar tasks.
+    std::list<Recurring> cyclic_;
+
+    // Protects cyclic_ and the collected_ flags of its entries.
+    std::mutex cyclicMutex_;
+
+    // Signalled when a collected cyclic task finished its run.
+    std::condition_variable cyclicIdle_;
+
+    // Signals new tasks in the inbox or the stop request.
+    internal::SchedulerSignal signal_;
+
+    // True while the dispatcher is about to wait or waits for signal_.
+    std::atomic<bool> sleeping_ = false;
+
+    // The deadline the dispatcher sleeps until, TimePoint::max() if it
+    // sleeps without a deadline and TimePoint::min() while it is awake.
+    // Producers only wake the dispatcher for earlier deadlines.
+    std::atomic<TimePoint> wakeAt_ = TimePoint::min();
 
     // If true the scheduler is in the shutdown process.
     std::atomic<bool> stop_ = false;
 
+    // The statistics.  Written by the dispatcher, except pending_.
+    util::Histogram lateness_;
+    std::atomic<uint64_t> pending_ = 0;
+    std::atomic<uint64_t> fired_ = 0;
+    std::atomic<uint64_t> batches_ = 0;
+    std::atomic<uint64_t> wakeups_ = 0;
+    std::atomic<int64_t> dispatchTime_ = 0;
+
+    /**
+     * A thread that performs the scheduling.  Declared last since it
+     * accesses the members above as soon as it is started.
+     */
+    std::thread dispatcher_;
+
     // A reference to the current Scheduler.
     inline static thread_local Scheduler* self_;
 
+    /**
+     * Wraps a thunk so that get_scheduler() works and the producer's
+     * context is set while it is executed.
+     */
+    auto bind( THUNK thunk, const ExecutionContext& context ) -> THUNK
+    {
+        return [this, thunk = std::move(thunk), context]() mutable {
+            ExecutionContext::Scope scope{ context };
+            self_ = this;
+            // Ensure that self_ is reset to nullptr when the task
+            // finishes, even if it throws an exception.
+            struct Guard { ~Guard() { self_ = nullptr; } } guard;
+            thunk();
+        };
+    }
+
+    /**
+     * Add a submission to the inbox and wake the dispatcher if it sleeps
+     * beyond the submission's deadline.  Submissions with a later
+     * deadline stay in the inbox until the dispatcher wakes up anyway.
+     * Producers only notify the signal if they are the first to find
+     * the dispatcher waiting.
+     */
+    auto push( Submission* submission ) -> void
+    {
+        pending_.fetch_add(1, std::memory_order_relaxed);
+
+        // The submission is owned by the dispatcher once it is pushed.
+        auto deadline = submission->deadline_;
+
+        submission->next_ = inbox_.load();
+        while (!inbox_.compare_exchange_weak(submission->next_, submission)) {
+        }
+
+        if (deadline < wakeAt_.load() && sleeping_.exchange(false)) {
+            signal_.notify();
+        }
+    }
+
+    /**
+     * Add a task to the inbox.
+     */
+    auto submit( TimePoint deadline, Entry entry ) -> void
+    {
+        push( new Submission{ nullptr, deadline, std::move(entry) } );
+    }
+
+    /**
+     * Check if a submission is embedded in a cyclic task.
+     */
+    static auto isEmbedded( const Submission* submission ) -> bool
+    {
+        auto recurring = submission->entry_.recurring_;
+
+        return recurring && submission == &recurring->submission_;
+    }
+
+    /**
+     * Take the content of the inbox.
+     *
+     * @return The taken submissions in submission order.
+     */
+    auto takeInbox() -> Submission*
+    {
+        Submission* reversed = nullptr;
+
+        for (auto c = inbox_.exchange(nullptr); c != nullptr; ) {
+            auto next = c->next_;
+            c->next_ = reversed;
+            reversed = c;
+            c = next;
+        }
+
+        return reversed;
+    }
+
+    /**
+     * Move the content of the inbox into the task map.
+     */
+    auto drainInbox() -> void
+    {
+        for (auto c = takeInbox(); c != nullptr; ) {
+            auto next = c->next_;
+
+            if (isEmbedded(c)) {
+                // Re-arm a cyclic task with its own node.
+                auto& node = c->entry_.recurring_->node_;
+                node.key() = c->deadline_;
+                node.mapped().due_ = c->entry_.due_;
+                ptasks_.insert( std::move(node) );
+            }
+            else {
+                ptasks_.emplace( c->deadline_, std::move(c->entry_) );
+                delete c;
+            }
+
+            c = next;
+        }
+    }
+
+    /**
+     * Discard the content of the inbox.
+     */
+    auto clearInbox() -> void
+    {
+        for (auto c = takeInbox(); c != nullptr; ) {
+            auto next = c->next_;
+
+            if (!isEmbedded(c)) {
+                delete c;
+            }
+
+            c = next;
+        }
+    }
+
+    /**
+     * Wait until the earliest deadline or until a task with an earlier
+     * deadline is submitted.
+     */
+    auto sleep() -> void
+    {
+        sleeping_ = true;
+
+        // Publish the wake-up time.  Producers that pushed before they
+        // could see it are found in the inbox.
+        while (true) {
+            wakeAt_ = ptasks_.empty() ? TimePoint::max() : ptasks_.begin()->first;
+
+            if (inbox_.load() == nullptr) {
+                break;
+            }
+
+            drainInbox();
+        }
+
+        TimePoint deadline = wakeAt_;
+
+        signal_.wait( deadline == TimePoint::max() ? nullptr : &deadline, [this]() {
+            return sleeping_ && !stop_;
+        });
+
+        sleeping_ = false;
+        wakeAt_ = TimePoint::min();
+
+        wakeups_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Take all due tasks from the task map.  Tasks with a slack are taken
+     * early if they are already due, which coalesces them with the task
+     * that caused the wake-up.  The scan stops at the first task that is
+     * not due, all following tasks have a later deadline.
+     */
+    auto collect( TimePoint now, std::vector<THUNK>& batch ) -> void
+    {
+        size_t count = 0;
+
+        for (auto first = ptasks_.begin();
+            first != ptasks_.end() && first->second.due_ <= now;
+            first = ptasks_.begin()) {
+            recordLateness( now - first->second.due_ );
+
+            if (auto recurring = first->second.recurring_) {
+                // Keep the node for re-arming.
+                recurring->node_ = ptasks_.extract(first);
+                {
+                    std::lock_guard<std::mutex> lock(cyclicMutex_);
+                    recurring->collected_ = true;
+                }
+                batch.push_back( RunThunk{ this, recurring } );
+            }
+            else {
+                batch.push_back(bind( std::move(first->second.task_), first->second.context_ ));
+                ptasks_.erase(first);
+            }
+
+            ++count;
+        }
+
+        if (count) {
+            pending_.fetch_sub(count, std::memory_order_relaxed);
+            fired_.fetch_add(count, std::memory_order_relaxed);
+            batches_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Add a value to the lateness histogram.
+     */
+    auto recordLateness( TimePoint::duration lateness ) -> void
+    {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(lateness).count();
+
+        lateness_.record( us > 0 ? static_cast<uint64_t>(us) : 0 );
+    }
+
     auto dispatch() -> void
     {
+        auto& batch = batch_;
+
         while (!stop_) {
-            auto now = std::chrono::system_clock::now();
+            auto start = std::chrono::steady_clock::now();
 
-            THUNK to_execute;
+            drainInbox();
 
-            {
-                std::unique_lock<std::mutex> lock(mutex_);
+            collect( clock_.now(), batch );
 
-                auto first = ptasks_.begin();
-                if (first == ptasks_.end()) {
-                    // No tasks, wait until a new one is scheduled.
-                    cv_.wait(lock);
+            dispatchTime_.fetch_add(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count(),
+                std::memory_order_relaxed);
 
-                    continue;
-                }
+            if (batch.empty()) {
+                // Wait until the next deadline is reached or an
+                // earlier task is scheduled.
+                sleep();
 
-                auto& [next, task] = *first;
+                continue;
+            }
 
-                if (next > now) {
-                    // Wait until the next task is due or a new task is scheduled.
-                    cv_.wait_until(lock, next);
+            consumer_( std::move(batch) );
 
-                    continue;
-                }
+            batch.clear();
+        }
+    }
 
-                to_execute = std::move(task);
+    /**
+     * Pass all tasks that are due until the passed deadline in a single
+     * batch to the consumer.  Cyclic and calendar tasks are executed once
+     * and not re-armed.  Called on stop after the dispatcher finished.
+     */
+    auto flush( TimePoint deadline ) -> void
+    {
+        drainInbox();
 
-                ptasks_.erase(first);
+        size_t count = 0;
+
+        // The map is ordered by the latest time including the slack, so
+        // an entry due before the deadline may follow one due after it.
+        for (auto it = ptasks_.begin(); it != ptasks_.end();) {
+            if (it->second.due_ > deadline) {
+                ++it;
+                continue;
             }
 
-            consumer_([this, thunk = std::move(to_execute)]() mutable {
-                self_ = this;
-                // Ensure that self_ is reset to nullptr when the task
-                // finishes, even if it throws an exception.
-                struct Guard { ~Guard() { self_ = nullptr; } } guard;
-                thunk();
-            });
+            if (auto recurring = it->second.recurring_) {
+                batch_.push_back(bind( recurring->task_, recurring->context_ ));
+            }
+            else {
+                batch_.push_back(bind( std::move(it->second.task_), it->second.context_ ));
+            }
+            it = ptasks_.erase(it);
+
+            ++count;
+        }
+
+        if (count == 0) {
+            return;
+        }
+
+        pending_.fetch_sub(count, std::memory_order_relaxed);
+        fired_.fetch_add(count, std::memory_order_relaxed);
+        batches_.fetch_add(1, std::memory_order_relaxed);
+
+        consume();
+    }
+
+    /**
+     * Get the next deadline on virtual time.
+     */
+    auto next() -> std::optional<TimePoint> override
+    {
+        if (stop_) {
+            return {};
+        }
+
+        drainInbox();
+
+        if (ptasks_.empty()) {
+            return {};
+        }
+
+        return ptasks_.begin()->first;
+    }
+
+    /**
+     * Execute the due tasks on virtual time.
+     */
+    auto step() -> void override
+    {
+        collect( clock_.now(), batch_ );
+
+        if (!batch_.empty()) {
+            consume();
+        }
+    }
+
+    /**
+     * Pass the batch to the consumer on the calling thread.  If the
+     * consumer throws, the cyclic tasks left in the batch end, so that
+     * the destructor does not wait for them.
+     */
+    auto consume() -> void
+    {
+        try {
+            consumer_( std::move(batch_) );
+        }
+        catch (...) {
+            release( batch_ );
+            batch_.clear();
+            throw;
+        }
+
+        batch_.clear();
+    }
+
+    /**
+     * The thunk of a cyclic or calendar task that is passed to the
+     * consumer.  Trivially copyable, so that it fits into the small
+     * buffer of the std::function and a cycle does not allocate.
+     */
+    struct RunThunk {
+        Scheduler* scheduler_;
+        Recurring* recurring_;
+
+        auto operator()() const -> void
+        {
+            scheduler_->run(recurring_);
+        }
+    };
+
+    static_assert(std::is_trivially_copyable_v<RunThunk>);
+
+    /**
+     * End the collected cyclic tasks in the passed batch that did not
+     * run.  Their entries may already be erased, so they are looked up
+     * by address.
+     */
+    auto release( const std::vector<THUNK>& batch ) -> void
+    {
+        std::lock_guard<std::mutex> lock(cyclicMutex_);
+
+        for (auto& thunk : batch) {
+            auto target = thunk.target<RunThunk>();
+            if (target == nullptr) {
+                continue;
+            }
+
+            for (auto it = cyclic_.begin(); it != cyclic_.end(); ++it) {
+                if (&*it == target->recurring_ && it->collected_) {
+                    cyclic_.erase(it);
+                    break;
+                }
+            }
         }
+
+        cyclicIdle_.notify_all();
     }
 
-    auto cycler(THUNK task, Duration cycleDuration) -> void
+    /**
+     * End a collected cyclic task after its run.  Re-arms it for the
+     * passed due time or erases it if there is none.  The scheduler may
+     * be destroyed as soon as the lock is released.
+     */
+    auto finish( Recurring* recurring, std::optional<TimePoint> due ) -> void
     {
+        std::lock_guard<std::mutex> lock(cyclicMutex_);
+
+        if (due) {
+            recurring->collected_ = false;
+            recurring->submission_.deadline_ = *due;
+            recurring->submission_.entry_.due_ = *due;
+            // Under the lock, so that the dispatcher can only mark the
+            // task as collected again after the flag was reset.
+            push( &recurring->submission_ );
+        }
+        else {
+            cyclic_.erase(recurring->position_);
+        }
+
+        cyclicIdle_.notify_all();
+    }
+
+    /**
+     * Execute a cyclic or calendar task and re-arm it.
+     */
+    auto run( Recurring* recurring ) -> void
+    {
+        self_ = this;
+        struct Guard {
+            ~Guard()
+            {
+                self_ = nullptr;
+            }
+        } guard;
+
         if (stop_) {
+            finish( recurring, {} );
             return;
         }
 
-        task();
+        try {
+            ExecutionContext::Scope scope{ recurring->context_ };
+            recurring->task_();
+        }
+        catch (...) {
+            // Cyclic execution ends.
+            finish( recurring, {} );
+            throw;
+        }
+
+        std::optional<TimePoint> due = clock_.now() + recurring->period_;
+        if (recurring->cron_) {
+            due = recurring->cron_->next(clock_.now());
+        }
 
-        scheduleIn(
-            [this, task = std::move(task), cycleDuration](){ cycler( std::move(task), cycleDuration ); },
-            cycleDuration );
+        finish( recurring, due );
+    }
+
+    /**
+     * Create a cyclic or calendar task.
+     */
+    auto scheduleRecurring(
+        THUNK task,
+        Duration period,
+        TimePoint due,
+        std::optional<CronExpression> cron = {}) -> bool
+    {
+        if (stop_) {
+            return false;
+        }
+
+        Recurring* recurring;
+        {
+            std::lock_guard<std::mutex> lock(cyclicMutex_);
+            recurring = &cyclic_.emplace_back();
+            recurring->position_ = std::prev(cyclic_.end());
+            recurring->task_ = std::move(task);
+            recurring->period_ = period;
+            recurring->cron_ = std::move(cron);
+            recurring->context_ = ExecutionContext::current();
+            recurring->submission_.entry_.recurring_ = recurring;
+        }
+
+        submit(
+            due,
+            Entry{ due, {}, recurring, recurring->context_ });
+
+        return true;
     }
 
 public:
@@ -116,7 +912,19 @@ public:
      * @param consumer The consumer to execute the scheduled tasks.
      */
     Scheduler(CONSUMER consumer)
-        : consumer_{consumer}
+        : Scheduler{toBatchConsumer(std::move(consumer))}
+    {
+    }
+
+    /**
+     * Create an instance that passes all tasks that are due at a
+     * wake-up of the scheduler in a single call to the consumer.
+     *
+     * @param consumer The consumer to execute the scheduled tasks.
+     */
+    Scheduler(BATCH_CONSUMER consumer)
+        : clock_{SystemClock::instance()}
+        , consumer_{std::move(consumer)}
         , dispatcher_{[this]() { dispatch(); }}
     {
     }
@@ -127,8 +935,48 @@ public:
      * @param consumer The consumer to execute the scheduled tasks.
      */
     Scheduler()
-        : consumer_{internalConsumer}
-        , dispatcher_{[this]() { dispatch(); }}
+        : Scheduler{CONSUMER{internalConsumer}}
+    {
+    }
+
+    /**
+     * Create an instance that runs on virtual time.  No dispatcher
+     * thread is started, the due tasks are passed to the consumer
+     * in time order on the thread that advances the clock.
+     *
+     * @param clock The clock driving the scheduler.  Must outlive the
+     * scheduler.
+     * @param consumer The consumer to execute the scheduled tasks.
+     */
+    Scheduler(VirtualClock& clock, BATCH_CONSUMER consumer)
+        : clock_{clock}
+        , consumer_{std::move(consumer)}
+        , virtualClock_{&clock}
+    {
+        clock.attach(*this);
+    }
+
+    /**
+     * Create an instance that runs on virtual time.
+     *
+     * @param clock The clock driving the scheduler.  Must outlive the
+     * scheduler.
+     * @param consumer The consumer to execute the scheduled tasks.
+     */
+    Scheduler(VirtualClock& clock, CONSUMER consumer)
+        : Scheduler{clock, toBatchConsumer(std::move(consumer))}
+    {
+    }
+
+    /**
+     * Create an instance that runs on virtual time.  The tasks are
+     * executed directly on the thread that advances the clock.
+     *
+     * @param clock The clock driving the scheduler.  Must outlive the
+     * scheduler.
+     */
+    Scheduler(VirtualClock& clock)
+        : Scheduler{clock, BATCH_CONSUMER{inlineConsumer}}
     {
     }
 
@@ -139,11 +987,28 @@ public:
 
     /**
      * Stop the scheduler.  Note that this blocks until all threads
-     * in the pool finished.
+     * in the pool finished and until the cyclic tasks passed to the
+     * consumer ran, which return immediately after the stop.  A
+     * consumer therefore has to execute every cyclic task it received
+     * and the scheduler must not be destroyed from one of its tasks.
      */
     ~Scheduler()
     {
         stop();
+
+        {
+            std::unique_lock<std::mutex> lock(cyclicMutex_);
+            cyclicIdle_.wait(lock, [this]() {
+                return std::none_of(cyclic_.begin(), cyclic_.end(),
+                    [](const Recurring& recurring) { return recurring.collected_; });
+            });
+        }
+
+        if (virtualClock_) {
+            virtualClock_->detach(*this);
+        }
+
+        clearInbox();
     }
 
     static auto get_scheduler() -> Scheduler&
@@ -155,47 +1020,111 @@ public:
         return *self_;
     }
 
+    /**
+     * Get a snapshot of the scheduler's statistics.  Can be called
+     * from any thread while the scheduler is running.
+     */
+    auto statistics() const -> Statistics
+    {
+        Statistics result;
+
+        result.latenessHistogram = lateness_.snapshot();
+        result.pending = pending_.load(std::memory_order_relaxed);
+        result.fired = fired_.load(std::memory_order_relaxed);
+        result.batches = batches_.load(std::memory_order_relaxed);
+        result.wakeups = wakeups_.load(std::memory_order_relaxed);
+        result.dispatchTime = std::chrono::nanoseconds{ dispatchTime_.load(std::memory_order_relaxed) };
+        result.at = std::chrono::steady_clock::now();
+
+        return result;
+    }
+
+    /**
+     * Get the current time of the scheduler's clock.
+     */
+    auto now() const -> TimePoint
+    {
+        return clock_.now();
+    }
+
     /**
      * Stop scheduling.  All pending tasks are discarded and no new tasks
      * are accepted.
      */
     void stop()
     {
-        {
-            // Modify the stop flag under lock.
-            std::lock_guard<std::mutex>lock{mutex_};
+        stop( Drain::None, TimePoint{} );
+    }
 
-            // Ignore if already stopped.
-            if (stop_) {
-                return;
-            }
+    /**
+     * Stop scheduling.  No new tasks are accepted.  Depending on the
+     * drain mode, the pending tasks that are due until the passed
+     * deadline are passed to the consumer in a single batch without
+     * waiting for their due time, all other tasks are discarded.  Since
+     * cyclic tasks are executed at most once, the time needed for the
+     * shutdown is bounded.
+     *
+     * @param drain The handling of the pending tasks.
+     * @param deadline The latest due time of the tasks to execute.
+     */
+    void stop( Drain drain, TimePoint deadline )
+    {
+        // Ignore if already stopped.
+        if (stop_.exchange(true)) {
+            return;
+        }
+
+        signal_.notify();
 
-            stop_ = true;
+        if (dispatcher_.joinable()) {
+            dispatcher_.join();
         }
 
-        cv_.notify_one();
+        if (drain == Drain::UntilDeadline) {
+            flush( deadline );
+        }
 
-        dispatcher_.join();
+        clearInbox();
+    }
+
+    /**
+     * Stop scheduling, see stop( Drain, TimePoint ).
+     *
+     * @param drain The handling of the pending tasks.
+     * @param horizon The latest due time of the tasks to execute
+     * relative to now.
+     */
+    void stop( Drain drain, Duration horizon )
+    {
+        stop( drain, clock_.now() + horizon );
     }
 
     /**
      * Register a task for scheduling.
      *
+     * @param task The task to execute.
+     * @param duration The delay until the task is due.
+     * @param slack The tolerance for the execution of the task.  The task
+     * is executed at some time between its due time and its due time plus
+     * the slack.  This allows the scheduler to execute tasks that are due
+     * at nearly the same time on a single wake-up.
      * @return false if the scheduler is already stopped, otherwise true.
+     * @throws std::invalid_argument if the slack is negative.
      */
-    auto scheduleIn(THUNK task, Duration duration) -> bool
+    auto scheduleIn(THUNK task, Duration duration, Duration slack = 0ms) -> bool
     {
-        {
-            std::lock_guard<std::mutex> lock(mutex_);
-            if (stop_) {
-                return false;
-            }
-            ptasks_.emplace(
-                std::chrono::system_clock::now() + duration,
-                move(task));
+        if (slack < 0ms) {
+            throw std::invalid_argument("slack must not be negative.");
         }
 
-        cv_.notify_one();
+        if (stop_) {
+            return false;
+        }
+
+        auto due = clock_.now() + duration;
+        submit(
+            due + slack,
+            Entry{ due, move(task), nullptr, ExecutionContext::current() });
 
         return true;
     }
@@ -215,26 +1144,31 @@ public:
     /**
      * Register a task for scheduling.
      *
-     * @return false if the scheduler is already stopped, otherwise true.
+     * @param task The task to execute.
+     * @param time The time when the task is due.
+     * @param slack The tolerance for the execution of the task, see
+     * scheduleIn().
+     * @return false if the scheduler is already stopped or the passed
+     * time is in the past, otherwise true.
+     * @throws std::invalid_argument if the slack is negative.
      */
-    auto scheduleAt(THUNK task, TimePoint time) -> bool
+    auto scheduleAt(THUNK task, TimePoint time, Duration slack = 0ms) -> bool
     {
-        if ( time < std::chrono::system_clock::now() ) {
-            return false;
+        if (slack < 0ms) {
+            throw std::invalid_argument("slack must not be negative.");
         }
 
-        {
-            std::lock_guard<std::mutex> lock(mutex_);
+        if ( time < clock_.now() ) {
+            return false;
+        }
 
-            if (stop_) {
-                return false;
-            }
-            ptasks_.emplace(
-                time,
-                move(task));
+        if (stop_) {
+            return false;
         }
 
-        cv_.notify_one();
+        submit(
+            time + slack,
+            Entry{ time, move(task), nullptr, ExecutionContext::current() });
 
         return true;
     }
@@ -250,13 +1184,7 @@ public:
      */
     auto scheduleCyclic(THUNK task, Duration cycleDuration) -> bool
     {
-        THUNK cyclerSelf =
-            [this, task = std::move(task), cycleDuration]()
-            {
-                cycler( std::move(task), cycleDuration );
-            };
-
-        return schedule( std::move(cyclerSelf) );
+        return scheduleRecurring( std::move(task), cycleDuration, clock_.now() );
     }
 
     /**
@@ -274,13 +1202,33 @@ public:
      */
     auto scheduleCyclic(THUNK task, Duration cycleDuration, TimePoint startAt) -> bool
     {
-        THUNK cyclerSelf =
-            [this, task = std::move(task), cycleDuration]()
-            {
-                cycler( std::move(task), cycleDuration );
-            };
+        if ( startAt < clock_.now() ) {
+            return false;
+        }
+
+        return scheduleRecurring( std::move(task), cycleDuration, startAt );
+    }
+
+    /**
+     * Schedule a task for execution at the times selected by a calendar
+     * expression, for example "0 2 * * *" for every day at 02:00.  The
+     * next time is computed directly from the expression after each
+     * execution, a pending task causes no wake-ups before it is due.
+     *
+     * @param task The task to execute. Note that the execution is stopped
+     * if the passed task throws an exception.
+     * @param cron The times to execute the task.
+     * @return false if the scheduler is already stopped or the expression
+     * selects no future time, otherwise true.
+     */
+    auto scheduleCron(THUNK task, const CronExpression& cron) -> bool
+    {
+        auto due = cron.next(clock_.now());
+        if (!due) {
+            return false;
+        }
 
-        return scheduleAt( std::move(cyclerSelf), startAt );
+        return scheduleRecurring( std::move(task), Duration{}, *due, cron );
     }
 };
 
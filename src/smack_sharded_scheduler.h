@@ -0,0 +1,274 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * A task scheduler distributing its tasks over several dispatchers.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "smack_common.h"
+#include "smack_scheduler.h"
+#include "smack_util.hpp"
+
+namespace smack {
+
+/**
+ * A task scheduler that runs a set of independent Scheduler shards, each
+ * with its own dispatcher thread and task map.  Offers the same interface
+ * as the Scheduler.  Tasks are placed on the shard associated with the
+ * calling thread, or on the shard selected by a key if one is passed.
+ * Note that there is no ordering guarantee between tasks placed on
+ * different shards.
+ */
+class ShardedScheduler {
+    std::vector<std::unique_ptr<Scheduler>> shards_;
+
+    static auto defaultShardCount() -> size_t
+    {
+        auto result = std::thread::hardware_concurrency();
+
+        return result != 0 ? result : 1;
+    }
+
+    /**
+     * Get the shard associated with the calling thread.
+     */
+    auto local() -> Scheduler&
+    {
+        return *shards_[thread_id() % shards_.size()];
+    }
+
+    /**
+     * Create the shards.
+     *
+     * @param make Creates a single shard.
+     */
+    template <typename F>
+    auto init( size_t shardCount, F make ) -> void
+    {
+        if (shardCount == 0) {
+            throw std::invalid_argument("shardCount must be greater than zero.");
+        }
+
+        shards_.reserve(shardCount);
+        for (size_t i = 0; i < shardCount; ++i) {
+            shards_.push_back(make());
+        }
+    }
+
+public:
+    /**
+     * Create an instance that allows to pass an external consumer.  The
+     * consumer is shared by all shards and must be thread-safe.
+     *
+     * @param consumer The consumer to execute the scheduled tasks.
+     * @param shardCount The number of shards.
+     * @throws std::invalid_argument If shardCount is zero.
+     */
+    ShardedScheduler(CONSUMER consumer, size_t shardCount = defaultShardCount())
+    {
+        init(shardCount, [&consumer]() {
+            return std::make_unique<Scheduler>(consumer);
+        });
+    }
+
+    /**
+     * Create an instance that passes the tasks in batches to a consumer.
+     * The consumer is shared by all shards and must be thread-safe.
+     *
+     * @param consumer The consumer to execute the scheduled tasks.
+     * @param shardCount The number of shards.
+     * @throws std::invalid_argument If shardCount is zero.
+     */
+    ShardedScheduler(BATCH_CONSUMER consumer, size_t shardCount = defaultShardCount())
+    {
+        init(shardCount, [&consumer]() {
+            return std::make_unique<Scheduler>(consumer);
+        });
+    }
+
+    /**
+     * Create an instance using the Scheduler's internal consumer.
+     *
+     * @param shardCount The number of shards.
+     * @throws std::invalid_argument If shardCount is zero.
+     */
+    explicit ShardedScheduler(size_t shardCount = defaultShardCount())
+    {
+        init(shardCount, []() {
+            return std::make_unique<Scheduler>();
+        });
+    }
+
+    ShardedScheduler(const ShardedScheduler&) = delete;
+    ShardedScheduler& operator=(const ShardedScheduler&) = delete;
+    ShardedScheduler(ShardedScheduler&&) = delete;
+    ShardedScheduler& operator=(ShardedScheduler&&) = delete;
+
+    /**
+     * Stop all shards.
+     */
+    ~ShardedScheduler()
+    {
+        stop();
+    }
+
+    /**
+     * Get the number of shards.
+     */
+    auto size() const -> size_t
+    {
+        return shards_.size();
+    }
+
+    /**
+     * Get a shard.
+     *
+     * @param index The shard index, must be less than size().
+     */
+    auto shard( size_t index ) -> Scheduler&
+    {
+        return *shards_.at(index);
+    }
+
+    /**
+     * Get the shard that is selected for a key.
+     */
+    auto shardFor( size_t key ) -> Scheduler&
+    {
+        return *shards_[std::hash<size_t>{}(key) % shards_.size()];
+    }
+
+    /**
+     * Get a snapshot of the statistics summed over all shards.  See
+     * Scheduler::statistics().
+     */
+    auto statistics() const -> Scheduler::Statistics
+    {
+        auto result = shards_.front()->statistics();
+
+        for (size_t i = 1; i < shards_.size(); ++i) {
+            auto shard = shards_[i]->statistics();
+            result.latenessHistogram.merge(shard.latenessHistogram);
+            result.pending += shard.pending;
+            result.fired += shard.fired;
+            result.batches += shard.batches;
+            result.wakeups += shard.wakeups;
+            result.dispatchTime += shard.dispatchTime;
+            result.at = shard.at;
+        }
+
+        return result;
+    }
+
+    /**
+     * Get the current time of the shards' clock.
+     */
+    auto now() const -> TimePoint
+    {
+        return shards_.front()->now();
+    }
+
+    /**
+     * Stop all shards.  All pending tasks are discarded and no new tasks
+     * are accepted.
+     */
+    void stop()
+    {
+        for (auto& shard : shards_) {
+            shard->stop();
+        }
+    }
+
+    /**
+     * Stop all shards.  See Scheduler::stop( Scheduler::Drain, TimePoint ).
+     */
+    void stop( Scheduler::Drain drain, TimePoint deadline )
+    {
+        for (auto& shard : shards_) {
+            shard->stop(drain, deadline);
+        }
+    }
+
+    /**
+     * Register a task for scheduling on the calling thread's shard.
+     * See Scheduler::scheduleIn().
+     */
+    auto scheduleIn(THUNK task, Duration duration, Duration slack = 0ms) -> bool
+    {
+        return local().scheduleIn(std::move(task), duration, slack);
+    }
+
+    /**
+     * Register a task for scheduling on the shard selected by a key.
+     * Tasks with the same key are placed on the same shard.
+     * See Scheduler::scheduleIn().
+     */
+    auto scheduleIn(size_t key, THUNK task, Duration duration, Duration slack = 0ms) -> bool
+    {
+        return shardFor(key).scheduleIn(std::move(task), duration, slack);
+    }
+
+    /**
+     * Schedule a task now on the calling thread's shard.
+     * See Scheduler::schedule().
+     */
+    auto schedule(THUNK task) -> bool
+    {
+        return local().schedule(std::move(task));
+    }
+
+    /**
+     * Register a task for scheduling on the calling thread's shard.
+     * See Scheduler::scheduleAt().
+     */
+    auto scheduleAt(THUNK task, TimePoint time, Duration slack = 0ms) -> bool
+    {
+        return local().scheduleAt(std::move(task), time, slack);
+    }
+
+    /**
+     * Register a task for scheduling on the shard selected by a key.
+     * See Scheduler::scheduleAt().
+     */
+    auto scheduleAt(size_t key, THUNK task, TimePoint time, Duration slack = 0ms) -> bool
+    {
+        return shardFor(key).scheduleAt(std::move(task), time, slack);
+    }
+
+    /**
+     * Schedule a task for cyclic execution on the calling thread's shard.
+     * See Scheduler::scheduleCyclic().
+     */
+    auto scheduleCyclic(THUNK task, Duration cycleDuration) -> bool
+    {
+        return local().scheduleCyclic(std::move(task), cycleDuration);
+    }
+
+    /**
+     * Schedule a task for cyclic execution on the calling thread's shard.
+     * See Scheduler::scheduleCyclic().
+     */
+    auto scheduleCyclic(THUNK task, Duration cycleDuration, TimePoint startAt) -> bool
+    {
+        return local().scheduleCyclic(std::move(task), cycleDuration, startAt);
+    }
+
+    /**
+     * Schedule a calendar task on the calling thread's shard.
+     * See Scheduler::scheduleCron().
+     */
+    auto scheduleCron(THUNK task, const CronExpression& cron) -> bool
+    {
+        return local().scheduleCron(std::move(task), cron);
+    }
+};
+
+} // namespace smack
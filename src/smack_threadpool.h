@@ -19,6 +19,7 @@
 #include <vector>
 
 #include "smack_common.h"
+#include "smack_execution_context.h"
 
 namespace smack {
 
@@ -32,8 +33,16 @@ private:
     // The worker threads.
     std::vector<std::thread> threads_;
 
+    /**
+     * A queued task with the context of its producer.
+     */
+    struct Task {
+        THUNK thunk_;
+        ExecutionContext context_;
+    };
+
     // The task queue.
-    std::queue<THUNK> tasks_;
+    std::queue<Task> tasks_;
 
     // Signals changes in the tasks queue.
     std::condition_variable cv_;
@@ -80,7 +89,7 @@ public:
                 self_ = this;
 
                 while (true) {
-                    THUNK task;
+                    Task task;
 
                     {
                         std::unique_lock<std::mutex> lock(mutex_);
@@ -100,7 +109,8 @@ public:
                     }
 
                     transactionId_ = ++tidCount_;
-                    task();
+                    ExecutionContext::Scope scope{ task.context_ };
+                    task.thunk_();
                 }
             });
         }
@@ -181,7 +191,8 @@ public:
     }
 
     /**
-     * Register a task for execution by the thread pool.
+     * Register a task for execution by the thread pool.  The calling
+     * thread's execution context is restored while the task runs.
      *
      * @param task The task to execute.
      * @throws std::runtime_error if the threadpool is already stopped.
@@ -195,12 +206,44 @@ public:
                 throw std::runtime_error("pool already stopped.");
             }
 
-            tasks_.emplace(move(task));
+            tasks_.push( Task{ move(task), ExecutionContext::current() } );
         }
 
         cv_.notify_one();
     }
 
+    /**
+     * Register a batch of tasks for execution by the thread pool.  The
+     * tasks are added to the queue in a single step.  Can be used as a
+     * Scheduler's batch consumer.
+     *
+     * @param tasks The tasks to execute.  These are moved out of the
+     * passed vector.
+     * @throws std::runtime_error if the threadpool is already stopped.
+     */
+    void exec(std::vector<THUNK>&& tasks)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+
+            if (stop_) {
+                throw std::runtime_error("pool already stopped.");
+            }
+
+            auto& context = ExecutionContext::current();
+            for (auto& task : tasks) {
+                tasks_.push( Task{ move(task), context } );
+            }
+        }
+
+        if (tasks.size() == 1) {
+            cv_.notify_one();
+        }
+        else if (!tasks.empty()) {
+            cv_.notify_all();
+        }
+    }
+
     /**
      * Get the size of the thread pool as passed in the constructor.
      */
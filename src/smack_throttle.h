@@ -0,0 +1,425 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Rate limiting primitives based on the task scheduler.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "smack_common.h"
+#include "smack_scheduler.h"
+
+namespace smack {
+
+/**
+ * A token bucket rate limiter.  Callers that find no token are queued
+ * and resumed by a single scheduler timer as soon as tokens are
+ * available again, no thread waits.
+ */
+class RateLimiter {
+    struct State {
+        std::mutex mutex_;
+        Scheduler& scheduler_;
+        // Tokens per second.
+        double rate_;
+        double burst_;
+        double tokens_;
+        TimePoint last_;
+        std::deque<THUNK> waiters_;
+        bool timerPending_ = false;
+        bool closed_ = false;
+
+        State( Scheduler& scheduler, double rate, double burst )
+            : scheduler_{scheduler}
+            , rate_{rate}
+            , burst_{burst}
+            , tokens_{burst}
+            , last_{scheduler.now()}
+        {
+        }
+
+        /**
+         * Add the tokens accumulated since the last refill.  Called
+         * under the lock.
+         */
+        auto refill() -> void
+        {
+            auto now = scheduler_.now();
+            std::chrono::duration<double> elapsed = now - last_;
+            last_ = now;
+
+            tokens_ = std::min(burst_, tokens_ + elapsed.count() * rate_);
+        }
+
+        /**
+         * Arm the timer for the next token.  Called under the lock.
+         */
+        static auto arm( const std::shared_ptr<State>& self ) -> void
+        {
+            if (self->timerPending_ || self->waiters_.empty()) {
+                return;
+            }
+
+            std::chrono::duration<double> missing{ (1.0 - self->tokens_) / self->rate_ };
+
+            self->timerPending_ = self->scheduler_.scheduleIn(
+                [self]() { release(self); },
+                std::max(
+                    Duration{1},
+                    std::chrono::ceil<Duration>(missing) ) );
+        }
+
+        /**
+         * Resume waiters for the available tokens.
+         */
+        static auto release( const std::shared_ptr<State>& self ) -> void
+        {
+            std::vector<THUNK> resumed;
+
+            {
+                std::lock_guard<std::mutex> lock(self->mutex_);
+
+                self->timerPending_ = false;
+
+                if (self->closed_) {
+                    return;
+                }
+
+                self->refill();
+
+                while (!self->waiters_.empty() && self->tokens_ >= 1.0) {
+                    self->tokens_ -= 1.0;
+                    resumed.push_back(std::move(self->waiters_.front()));
+                    self->waiters_.pop_front();
+                }
+
+                arm(self);
+            }
+
+            for (auto& thunk : resumed) {
+                thunk();
+            }
+        }
+    };
+
+    std::shared_ptr<State> state_;
+
+public:
+    /**
+     * Create an instance.
+     *
+     * @param scheduler The scheduler used to resume waiting callers.
+     * @param tokensPerSecond The rate at which tokens are added.
+     * @param burst The maximum number of tokens.  The bucket is full
+     * initially.
+     * @throws std::invalid_argument If the rate is not positive or the
+     * burst is less than one.
+     */
+    RateLimiter( Scheduler& scheduler, double tokensPerSecond, double burst = 1.0 )
+    {
+        if (tokensPerSecond <= 0.0) {
+            throw std::invalid_argument("tokensPerSecond must be greater than zero.");
+        }
+        if (burst < 1.0) {
+            throw std::invalid_argument("burst must be at least one.");
+        }
+
+        state_ = std::make_shared<State>(scheduler, tokensPerSecond, burst);
+    }
+
+    RateLimiter(const RateLimiter&) = delete;
+    RateLimiter& operator=(const RateLimiter&) = delete;
+
+    /**
+     * Drops all waiting callers.
+     */
+    ~RateLimiter()
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex_);
+        state_->closed_ = true;
+        state_->waiters_.clear();
+    }
+
+    /**
+     * Take a token if one is available.
+     *
+     * @return true if a token was taken.
+     */
+    auto tryAcquire() -> bool
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex_);
+
+        state_->refill();
+
+        if (!state_->waiters_.empty() || state_->tokens_ < 1.0) {
+            return false;
+        }
+
+        state_->tokens_ -= 1.0;
+
+        return true;
+    }
+
+    /**
+     * Take a token and execute the passed thunk.  If a token is available
+     * and no other caller waits, the thunk is executed directly on the
+     * calling thread.  Otherwise it is queued and executed by the
+     * scheduler when a token becomes available.  Waiting callers are
+     * resumed in call order.
+     *
+     * @param thunk The thunk to execute.
+     */
+    auto acquire( THUNK thunk ) -> void
+    {
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex_);
+
+            state_->refill();
+
+            if (!state_->waiters_.empty() || state_->tokens_ < 1.0) {
+                state_->waiters_.push_back(std::move(thunk));
+                State::arm(state_);
+                return;
+            }
+
+            state_->tokens_ -= 1.0;
+        }
+
+        thunk();
+    }
+
+    /**
+     * Get the number of waiting callers.
+     */
+    auto waiting() const -> size_t
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex_);
+
+        return state_->waiters_.size();
+    }
+};
+
+/**
+ * Limits the execution of thunks to one per interval.  A call outside
+ * the current interval is executed immediately.  Calls within the interval
+ * replace each other, the last one is executed by a scheduler timer at
+ * the end of the interval.
+ */
+class Throttle {
+    struct State {
+        std::mutex mutex_;
+        Scheduler& scheduler_;
+        Duration interval_;
+        // The end of the current interval.
+        TimePoint blockedUntil_;
+        THUNK trailing_;
+        bool timerPending_ = false;
+        bool closed_ = false;
+
+        State( Scheduler& scheduler, Duration interval )
+            : scheduler_{scheduler}
+            , interval_{interval}
+        {
+        }
+
+        static auto fire( const std::shared_ptr<State>& self ) -> void
+        {
+            THUNK thunk;
+
+            {
+                std::lock_guard<std::mutex> lock(self->mutex_);
+
+                self->timerPending_ = false;
+
+                if (self->closed_ || !self->trailing_) {
+                    return;
+                }
+
+                thunk = std::move(self->trailing_);
+                self->trailing_ = nullptr;
+                self->blockedUntil_ = self->scheduler_.now() + self->interval_;
+            }
+
+            thunk();
+        }
+    };
+
+    std::shared_ptr<State> state_;
+
+public:
+    /**
+     * Create an instance.
+     *
+     * @param scheduler The scheduler used to execute delayed thunks.
+     * @param interval The minimum time between two executions.
+     */
+    Throttle( Scheduler& scheduler, Duration interval )
+        : state_{ std::make_shared<State>(scheduler, interval) }
+    {
+    }
+
+    Throttle(const Throttle&) = delete;
+    Throttle& operator=(const Throttle&) = delete;
+
+    /**
+     * Drops a pending trailing call.
+     */
+    ~Throttle()
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex_);
+        state_->closed_ = true;
+        state_->trailing_ = nullptr;
+    }
+
+    /**
+     * Execute a thunk subject to the throttling.
+     *
+     * @param thunk The thunk to execute.
+     */
+    auto call( THUNK thunk ) -> void
+    {
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex_);
+
+            auto now = state_->scheduler_.now();
+
+            if (now < state_->blockedUntil_ || state_->timerPending_) {
+                state_->trailing_ = std::move(thunk);
+
+                if (!state_->timerPending_) {
+                    auto self = state_;
+                    state_->timerPending_ = state_->scheduler_.scheduleIn(
+                        [self]() { State::fire(self); },
+                        std::chrono::ceil<Duration>(state_->blockedUntil_ - now) );
+                }
+
+                return;
+            }
+
+            state_->blockedUntil_ = now + state_->interval_;
+        }
+
+        thunk();
+    }
+};
+
+/**
+ * Delays the execution of a thunk until no further call happened for a
+ * quiet period.  Only the thunk of the last call is executed.  Uses a
+ * single scheduler timer that is re-armed if calls happened while it
+ * was pending.
+ */
+class Debounce {
+    struct State {
+        std::mutex mutex_;
+        Scheduler& scheduler_;
+        Duration delay_;
+        // The time when the last call becomes due.
+        TimePoint due_;
+        THUNK pending_;
+        bool timerPending_ = false;
+        bool closed_ = false;
+
+        State( Scheduler& scheduler, Duration delay )
+            : scheduler_{scheduler}
+            , delay_{delay}
+        {
+        }
+
+        /**
+         * Arm the timer for the current due time.  Called under the lock.
+         */
+        static auto arm( const std::shared_ptr<State>& self ) -> void
+        {
+            auto delay = self->due_ - self->scheduler_.now();
+
+            self->timerPending_ = self->scheduler_.scheduleIn(
+                [self]() { fire(self); },
+                std::max(
+                    Duration{},
+                    std::chrono::ceil<Duration>(delay) ) );
+        }
+
+        static auto fire( const std::shared_ptr<State>& self ) -> void
+        {
+            THUNK thunk;
+
+            {
+                std::lock_guard<std::mutex> lock(self->mutex_);
+
+                self->timerPending_ = false;
+
+                if (self->closed_ || !self->pending_) {
+                    return;
+                }
+
+                if (self->scheduler_.now() < self->due_) {
+                    // Called again while the timer was pending.
+                    arm(self);
+                    return;
+                }
+
+                thunk = std::move(self->pending_);
+                self->pending_ = nullptr;
+            }
+
+            thunk();
+        }
+    };
+
+    std::shared_ptr<State> state_;
+
+public:
+    /**
+     * Create an instance.
+     *
+     * @param scheduler The scheduler used to execute the thunks.
+     * @param delay The quiet period after the last call.
+     */
+    Debounce( Scheduler& scheduler, Duration delay )
+        : state_{ std::make_shared<State>(scheduler, delay) }
+    {
+    }
+
+    Debounce(const Debounce&) = delete;
+    Debounce& operator=(const Debounce&) = delete;
+
+    /**
+     * Drops a pending call.
+     */
+    ~Debounce()
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex_);
+        state_->closed_ = true;
+        state_->pending_ = nullptr;
+    }
+
+    /**
+     * Request the execution of a thunk.  Replaces a pending thunk and
+     * restarts the quiet period.
+     *
+     * @param thunk The thunk to execute.
+     */
+    auto call( THUNK thunk ) -> void
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex_);
+
+        state_->pending_ = std::move(thunk);
+        state_->due_ = state_->scheduler_.now() + state_->delay_;
+
+        if (!state_->timerPending_) {
+            State::arm(state_);
+        }
+    }
+};
+
+} // namespace smack
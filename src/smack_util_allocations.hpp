@@ -0,0 +1,115 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Allocation counting.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace smack {
+namespace util {
+
+/**
+ * The allocations made by a thread.
+ */
+struct AllocationCount {
+  uint64_t allocations = 0;
+  uint64_t bytes = 0;
+};
+
+/**
+ * Counts the calls of operator new per thread.  Counting is opt-in:
+ * exactly one translation unit of the program, typically the one with
+ * main(), has to install the hook by placing SMACK_ALLOCATION_HOOK at
+ * namespace scope.  The hook replaces the global operator new and
+ * delete and forwards to malloc and free.
+ */
+class AllocationCounter {
+public:
+  /**
+   * @return true if SMACK_ALLOCATION_HOOK is part of the program.
+   */
+  static bool installed() {
+    return installed_;
+  }
+
+  /**
+   * @return The allocations of the calling thread since it started.
+   */
+  static AllocationCount current() {
+    return count_;
+  }
+
+  /**
+   * Count an allocation of the calling thread.  Called by the hook.
+   */
+  static void record(size_t bytes) {
+    count_.allocations++;
+    count_.bytes += bytes;
+  }
+
+  /**
+   * Called by the hook during static initialization.
+   *
+   * @return true.
+   */
+  static bool install() {
+    installed_ = true;
+    return true;
+  }
+
+private:
+  static bool installed_;
+  static thread_local AllocationCount count_;
+};
+
+inline bool AllocationCounter::installed_ = false;
+inline thread_local AllocationCount AllocationCounter::count_;
+
+/**
+ * Allocate for the hook.
+ */
+inline void* countedAllocate(size_t size) {
+  AllocationCounter::record(size);
+
+  if (void* result = std::malloc(size ? size : 1))
+    return result;
+
+  throw std::bad_alloc{};
+}
+
+} // namespace util
+} // namespace smack
+
+/**
+ * Replaces the global operator new and delete to count allocations,
+ * see AllocationCounter.  Place at namespace scope in exactly one
+ * translation unit of the program.
+ */
+#define SMACK_ALLOCATION_HOOK \
+  void* operator new(std::size_t size) { \
+    return ::smack::util::countedAllocate(size); \
+  } \
+  void* operator new[](std::size_t size) { \
+    return ::smack::util::countedAllocate(size); \
+  } \
+  void operator delete(void* p) noexcept { \
+    std::free(p); \
+  } \
+  void operator delete[](void* p) noexcept { \
+    std::free(p); \
+  } \
+  void operator delete(void* p, std::size_t) noexcept { \
+    std::free(p); \
+  } \
+  void operator delete[](void* p, std::size_t) noexcept { \
+    std::free(p); \
+  } \
+  static const bool smack_allocation_hook_installed = \
+    ::smack::util::AllocationCounter::install()
@@ -0,0 +1,525 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Micro benchmarks.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <iomanip>
+#include <iostream>
+#include <regex>
+#include <stdexcept>
+
+#include "smack_cli.hpp"
+#include "smack_util_benchmark.hpp"
+
+namespace smack {
+namespace util {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * Get the time of a run of the passed number of iterations in seconds.
+ */
+double measure(const std::function<void(size_t)>& function, size_t iterations) {
+  auto start = Clock::now();
+  function(iterations);
+  clobber_memory();
+  std::chrono::duration<double> elapsed = Clock::now() - start;
+
+  return elapsed.count();
+}
+
+double nanos(double seconds) {
+  return seconds * 1e9;
+}
+
+std::string escapeJson(const std::string& in) {
+  std::string result;
+
+  for (auto c : in) {
+    if (c == '"' || c == '\\')
+      result += '\\';
+    result += c;
+  }
+
+  return result;
+}
+
+/**
+ * Quote a CSV field, embedded quotes are doubled.
+ */
+std::string quoteCsv(const std::string& in) {
+  std::string result{ '"' };
+
+  for (auto c : in) {
+    if (c == '"')
+      result += '"';
+    result += c;
+  }
+
+  return result + '"';
+}
+
+void printComplexities(
+  std::ostream& out,
+  const std::vector<ComplexityResult>& complexities,
+  Benchmark::Format format) {
+  switch (format) {
+  case Benchmark::Format::Text:
+    out << '\n' << std::left << std::setw(32) << "complexity"
+      << std::setw(14) << "fit"
+      << std::right
+      << std::setw(16) << "coefficient ns"
+      << std::setw(10) << "rms %" << '\n';
+    for (const auto& c : complexities) {
+      out << std::left << std::setw(32) << c.name
+        << std::setw(14) << Benchmark::name(c.complexity)
+        << std::right << std::fixed << std::setprecision(3)
+        << std::setw(16) << nanos(c.coefficient)
+        << std::setprecision(1)
+        << std::setw(10) << 100.0 * c.rms << '\n';
+    }
+    break;
+
+  case Benchmark::Format::Csv:
+    out << "\nname,complexity,coefficient_ns,rms\n";
+    for (const auto& c : complexities) {
+      out << quoteCsv(c.name) << ','
+        << quoteCsv(Benchmark::name(c.complexity)) << ','
+        << nanos(c.coefficient) << ','
+        << c.rms << '\n';
+    }
+    break;
+
+  case Benchmark::Format::Json:
+    // A member of the document written by print.
+    out << ",\n  \"complexity\": [";
+    for (size_t i = 0; i < complexities.size(); i++) {
+      const auto& c = complexities[i];
+      out << (i ? "," : "") << "\n    {"
+        << "\"name\": \"" << escapeJson(c.name) << "\", "
+        << "\"complexity\": \"" << Benchmark::name(c.complexity) << "\", "
+        << "\"coefficient_ns\": " << nanos(c.coefficient) << ", "
+        << "\"rms\": " << c.rms << "}";
+    }
+    out << "\n  ]";
+    break;
+  }
+}
+
+/**
+ * Get f(n) of a complexity class.
+ */
+double cost(Complexity complexity, double n) {
+  switch (complexity) {
+  case Complexity::O1:
+    return 1.0;
+  case Complexity::OLogN:
+    return std::log2(n);
+  case Complexity::ON:
+    return n;
+  case Complexity::ONLogN:
+    return n * std::log2(n);
+  case Complexity::ON2:
+    return n * n;
+  }
+
+  return 1.0;
+}
+
+} // namespace
+
+std::vector<Benchmark::Entry>& Benchmark::registry() {
+  static std::vector<Entry> result;
+  return result;
+}
+
+bool Benchmark::add(const char* name, Function function) {
+  registry().push_back({ name, function, nullptr, 0, 0 });
+  return true;
+}
+
+bool Benchmark::add(const char* name, RangeFunction function, size_t from, size_t to) {
+  if (from == 0 || from > to)
+    throw std::invalid_argument(std::string("Invalid range for benchmark ") + name);
+
+  registry().push_back({ name, nullptr, function, from, to });
+  return true;
+}
+
+std::vector<std::string> Benchmark::names() {
+  std::vector<std::string> result;
+
+  for (const auto& entry : registry())
+    result.push_back(entry.name);
+
+  std::sort(result.begin(), result.end());
+
+  return result;
+}
+
+BenchmarkResult Benchmark::run(
+  const std::string& name,
+  const std::function<void(size_t)>& function,
+  const Options& options) {
+  auto samples = std::max<size_t>(options.samples, 1);
+
+  // Warm up caches, branch predictors and the clock frequency.
+  auto warmupEnd = Clock::now() + options.warmup;
+  do {
+    function(1);
+  } while (Clock::now() < warmupEnd);
+
+  // Calibrate the iterations so that a sample takes its share of the
+  // budget.
+  std::chrono::duration<double> budget = options.budget;
+  double target = budget.count() / samples;
+  size_t iterations = 1;
+  for (auto elapsed = measure(function, iterations);
+       elapsed < target;
+       elapsed = measure(function, iterations)) {
+    // Grow by at most a factor of ten to stay robust against timer noise.
+    double factor = elapsed > 0.0 ? target / elapsed : 10.0;
+    iterations = static_cast<size_t>(
+      iterations * std::clamp(factor * 1.1, 1.5, 10.0)) + 1;
+  }
+
+  std::vector<double> times;
+  times.reserve(samples);
+  auto allocated = AllocationCounter::current();
+  for (size_t i = 0; i < samples; i++)
+    times.push_back(measure(function, iterations) / iterations);
+  auto allocatedEnd = AllocationCounter::current();
+
+  double total = double(samples) * iterations;
+
+  auto statistics = TimeProbe::evaluate(times);
+  statistics.allocations =
+    (allocatedEnd.allocations - allocated.allocations) / total;
+  statistics.allocatedBytes =
+    (allocatedEnd.bytes - allocated.bytes) / total;
+
+  return { name, 0, iterations, statistics };
+}
+
+std::vector<BenchmarkResult> Benchmark::run(
+  const std::string& filter,
+  const Options& options) {
+  std::regex pattern{ filter };
+
+  auto entries = registry();
+  std::sort(entries.begin(), entries.end(),
+    [](const Entry& a, const Entry& b) { return a.name < b.name; });
+
+  std::vector<BenchmarkResult> result;
+
+  for (const auto& entry : entries) {
+    if (!std::regex_search(entry.name, pattern))
+      continue;
+
+    if (entry.function) {
+      result.push_back(run(entry.name, entry.function, options));
+      continue;
+    }
+
+    for (auto n = entry.from; n <= entry.to; n *= 2) {
+      auto range = entry.range;
+      auto r = run(
+        entry.name + "/" + std::to_string(n),
+        [range, n](size_t iterations) { range(iterations, n); },
+        options);
+      r.size = n;
+      result.push_back(r);
+
+      // Guard against overflow.
+      if (n > entry.to / 2)
+        break;
+    }
+  }
+
+  return result;
+}
+
+std::vector<ComplexityResult> Benchmark::fit(
+  const std::vector<BenchmarkResult>& results) {
+  // The sizes and times by benchmark in the order of the results.
+  std::vector<std::string> names;
+  std::map<std::string, std::pair<std::vector<size_t>, std::vector<double>>> series;
+
+  for (const auto& r : results) {
+    if (r.size == 0)
+      continue;
+
+    auto name = r.name.substr(0, r.name.rfind('/'));
+    if (!series.count(name))
+      names.push_back(name);
+
+    auto& s = series[name];
+    s.first.push_back(r.size);
+    s.second.push_back(r.statistics.median);
+  }
+
+  std::vector<ComplexityResult> result;
+
+  for (const auto& name : names) {
+    const auto& s = series[name];
+    if (s.first.size() < 2)
+      continue;
+
+    auto c = fit(s.first, s.second);
+    c.name = name;
+    result.push_back(c);
+  }
+
+  return result;
+}
+
+ComplexityResult Benchmark::fit(
+  const std::vector<size_t>& sizes,
+  const std::vector<double>& times) {
+  ComplexityResult result;
+
+  if (sizes.empty() || sizes.size() != times.size())
+    return result;
+
+  double mean = 0.0;
+  for (auto t : times)
+    mean += t;
+  mean /= times.size();
+
+  bool first = true;
+
+  for (auto complexity : {
+    Complexity::O1,
+    Complexity::OLogN,
+    Complexity::ON,
+    Complexity::ONLogN,
+    Complexity::ON2 }) {
+    // Least squares of times = coefficient * f(n).
+    double tf = 0.0;
+    double ff = 0.0;
+    for (size_t i = 0; i < sizes.size(); i++) {
+      auto f = cost(complexity, static_cast<double>(sizes[i]));
+      tf += times[i] * f;
+      ff += f * f;
+    }
+    if (ff == 0.0)
+      continue;
+
+    double coefficient = tf / ff;
+
+    double squares = 0.0;
+    for (size_t i = 0; i < sizes.size(); i++) {
+      auto residual =
+        times[i] - coefficient * cost(complexity, static_cast<double>(sizes[i]));
+      squares += residual * residual;
+    }
+    double rms = mean > 0.0
+      ? std::sqrt(squares / sizes.size()) / mean
+      : 0.0;
+
+    if (first || rms < result.rms) {
+      result.complexity = complexity;
+      result.coefficient = coefficient;
+      result.rms = rms;
+      first = false;
+    }
+  }
+
+  return result;
+}
+
+const char* Benchmark::name(Complexity complexity) {
+  switch (complexity) {
+  case Complexity::O1:
+    return "O(1)";
+  case Complexity::OLogN:
+    return "O(log n)";
+  case Complexity::ON:
+    return "O(n)";
+  case Complexity::ONLogN:
+    return "O(n log n)";
+  case Complexity::ON2:
+    return "O(n^2)";
+  }
+
+  return "";
+}
+
+void Benchmark::print(
+  std::ostream& out,
+  const std::vector<BenchmarkResult>& results,
+  Format format) {
+  print(out, results, {}, format);
+}
+
+void Benchmark::print(
+  std::ostream& out,
+  const std::vector<BenchmarkResult>& results,
+  const std::vector<ComplexityResult>& complexities,
+  Format format) {
+  // The stream belongs to the caller.
+  auto flags = out.flags();
+  auto precision = out.precision();
+
+  switch (format) {
+  case Format::Text:
+    out << std::left << std::setw(32) << "benchmark"
+      << std::right
+      << std::setw(14) << "iterations"
+      << std::setw(12) << "min ns"
+      << std::setw(12) << "median ns"
+      << std::setw(12) << "p99 ns"
+      << std::setw(12) << "stddev ns"
+      << std::setw(10) << "outliers"
+      << std::setw(10) << "allocs"
+      << std::setw(12) << "bytes" << '\n';
+    for (const auto& r : results) {
+      const auto& s = r.statistics;
+      out << std::left << std::setw(32) << r.name
+        << std::right << std::fixed << std::setprecision(1)
+        << std::setw(14) << r.iterations
+        << std::setw(12) << nanos(s.min)
+        << std::setw(12) << nanos(s.median)
+        << std::setw(12) << nanos(s.p99)
+        << std::setw(12) << nanos(s.stddev)
+        << std::setw(10) << s.outliers
+        << std::setw(10) << s.allocations
+        << std::setw(12) << s.allocatedBytes << '\n';
+    }
+    break;
+
+  case Format::Csv:
+    out << "name,iterations,samples,min_ns,max_ns,mean_ns,median_ns,"
+      "p90_ns,p99_ns,p999_ns,stddev_ns,outliers,allocations,bytes\n";
+    for (const auto& r : results) {
+      const auto& s = r.statistics;
+      out << quoteCsv(r.name) << ','
+        << r.iterations << ','
+        << s.samples << ','
+        << nanos(s.min) << ','
+        << nanos(s.max) << ','
+        << nanos(s.mean) << ','
+        << nanos(s.median) << ','
+        << nanos(s.p90) << ','
+        << nanos(s.p99) << ','
+        << nanos(s.p999) << ','
+        << nanos(s.stddev) << ','
+        << s.outliers << ','
+        << s.allocations << ','
+        << s.allocatedBytes << '\n';
+    }
+    break;
+
+  case Format::Json:
+    out << "{\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+      const auto& r = results[i];
+      const auto& s = r.statistics;
+      out << (i ? "," : "") << "\n    {"
+        << "\"name\": \"" << escapeJson(r.name) << "\", "
+        << "\"iterations\": " << r.iterations << ", "
+        << "\"samples\": " << s.samples << ", "
+        << "\"min_ns\": " << nanos(s.min) << ", "
+        << "\"max_ns\": " << nanos(s.max) << ", "
+        << "\"mean_ns\": " << nanos(s.mean) << ", "
+        << "\"median_ns\": " << nanos(s.median) << ", "
+        << "\"p90_ns\": " << nanos(s.p90) << ", "
+        << "\"p99_ns\": " << nanos(s.p99) << ", "
+        << "\"p999_ns\": " << nanos(s.p999) << ", "
+        << "\"stddev_ns\": " << nanos(s.stddev) << ", "
+        << "\"outliers\": " << s.outliers << ", "
+        << "\"allocations\": " << s.allocations << ", "
+        << "\"bytes\": " << s.allocatedBytes << "}";
+    }
+    out << "\n  ]";
+    break;
+  }
+
+  if (!complexities.empty())
+    printComplexities(out, complexities, format);
+  if (format == Format::Json)
+    out << "\n}\n";
+
+  out.flags(flags);
+  out.precision(precision);
+}
+
+Benchmark::Format Benchmark::format(const std::string& name) {
+  if (name == "text")
+    return Format::Text;
+  if (name == "csv")
+    return Format::Csv;
+  if (name == "json")
+    return Format::Json;
+
+  throw std::invalid_argument("Unknown format: " + name);
+}
+
+namespace {
+
+int list() {
+  for (const auto& name : Benchmark::names())
+    std::cout << name << '\n';
+
+  return EXIT_SUCCESS;
+}
+
+int runFiltered(const std::string& filter, const std::string& format, unsigned budgetMs) {
+  auto f = Benchmark::format(format);
+
+  Benchmark::Options options;
+  options.budget = std::chrono::milliseconds{ budgetMs };
+
+  auto results = Benchmark::run(filter, options);
+  Benchmark::print(std::cout, results, Benchmark::fit(results), f);
+
+  return EXIT_SUCCESS;
+}
+
+int runFormat(const std::string& filter, const std::string& format) {
+  return runFiltered(filter, format, 500);
+}
+
+int runFilter(const std::string& filter) {
+  return runFiltered(filter, "text", 500);
+}
+
+int runAll() {
+  return runFiltered("", "text", 500);
+}
+
+} // namespace
+
+int Benchmark::main(int argc, char** argv) {
+  using smack::cli::Commands;
+
+  smack::cli::CliApplication cli{
+    "Runs micro benchmarks.",
+
+    Commands::make<list>(
+      "list", "List the benchmarks."),
+    Commands::make<runAll>(
+      "run", "Run all benchmarks."),
+    Commands::make<runFilter>(
+      "run", "Run the benchmarks matching a regular expression.",
+      { "filter" }),
+    Commands::make<runFormat>(
+      "run", "Run the matching benchmarks, format is text, csv or json.",
+      { "filter", "format" }),
+    Commands::make<runFiltered>(
+      "run", "Run the matching benchmarks with a time budget per benchmark.",
+      { "filter", "format", "budgetMs" })
+  };
+
+  return cli.launch(argc, argv);
+}
+
+} // namespace util
+} // namespace smack
@@ -0,0 +1,269 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Micro benchmarks.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "smack_util_time_probe.hpp"
+
+namespace smack {
+namespace util {
+
+/**
+ * Prevents the compiler from optimizing away the computation of the
+ * passed value.
+ */
+template <typename T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static const void* volatile sink;
+  sink = &value;
+#endif
+}
+
+/**
+ * Prevents the compiler from reordering or removing memory accesses
+ * across this call.
+ */
+inline void clobber_memory() {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : : "memory");
+#else
+  std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+/**
+ * The result of a benchmark.  The statistics hold the time and the
+ * allocations of a single iteration, the time in seconds.
+ */
+struct BenchmarkResult {
+  std::string name;
+  // The input size of a parameterised benchmark, zero otherwise.
+  size_t size = 0;
+  // The iterations per sample as determined by the calibration.
+  size_t iterations = 0;
+  ProfileResult statistics;
+};
+
+/**
+ * The complexity classes used for fitting.
+ */
+enum class Complexity { O1, OLogN, ON, ONLogN, ON2 };
+
+/**
+ * The best fit of the median times of a parameterised benchmark to a
+ * complexity class, time = coefficient * f(n).
+ */
+struct ComplexityResult {
+  std::string name;
+  Complexity complexity = Complexity::O1;
+  // The time in seconds per unit of f(n).
+  double coefficient = 0.0;
+  // The root mean square of the residuals relative to the mean time.
+  double rms = 0.0;
+};
+
+/**
+ * A registry and runner for micro benchmarks.  Benchmarks are registered
+ * using the SMACK_BENCHMARK macro.  A benchmark is first warmed up, then
+ * the number of iterations per sample is calibrated so that the samples
+ * fill the time budget.  The statistics are computed over the per
+ * iteration times of the samples.
+ */
+class Benchmark {
+public:
+  /**
+   * Executes the passed number of benchmark iterations.
+   */
+  using Function = void (*)(size_t iterations);
+
+  /**
+   * Executes the passed number of iterations of a parameterised
+   * benchmark on the input size n.
+   */
+  using RangeFunction = void (*)(size_t iterations, size_t n);
+
+  /**
+   * The output formats.
+   */
+  enum class Format { Text, Csv, Json };
+
+  /**
+   * The run configuration.
+   */
+  struct Options {
+    // The time for the measurement of a single benchmark.
+    std::chrono::milliseconds budget{ 500 };
+    // The time for the warm-up of a single benchmark.
+    std::chrono::milliseconds warmup{ 50 };
+    // The number of samples.
+    size_t samples = 30;
+  };
+
+  /**
+   * Register a benchmark.  Use the SMACK_BENCHMARK macro.
+   *
+   * @return true.
+   */
+  static bool add(const char* name, Function function);
+
+  /**
+   * Register a parameterised benchmark that is run for the input sizes
+   * from, 2 * from, 4 * from, ... up to to.  Use the
+   * SMACK_BENCHMARK_RANGE macro.
+   *
+   * @return true.
+   * @throws std::invalid_argument If from is zero or larger than to.
+   */
+  static bool add(const char* name, RangeFunction function, size_t from, size_t to);
+
+  /**
+   * Get the names of the registered benchmarks.
+   */
+  static std::vector<std::string> names();
+
+  /**
+   * Run a single benchmark function.
+   */
+  static BenchmarkResult run(
+    const std::string& name,
+    const std::function<void(size_t)>& function,
+    const Options& options);
+
+  /**
+   * Run the registered benchmarks whose names match the passed regular
+   * expression.  Parameterised benchmarks add a result per input size
+   * named name/size.
+   *
+   * @throws std::regex_error If the filter is not a valid regular
+   * expression.
+   */
+  static std::vector<BenchmarkResult> run(
+    const std::string& filter,
+    const Options& options);
+
+  /**
+   * Fit the median times of the parameterised benchmarks in the passed
+   * results to the complexity classes.
+   *
+   * @return The best fit per parameterised benchmark with at least two
+   * input sizes.
+   */
+  static std::vector<ComplexityResult> fit(
+    const std::vector<BenchmarkResult>& results);
+
+  /**
+   * Fit times to the complexity classes.
+   *
+   * @param sizes The input sizes.
+   * @param times The times in seconds for the input sizes.
+   * @return The fit with the smallest relative error.
+   */
+  static ComplexityResult fit(
+    const std::vector<size_t>& sizes,
+    const std::vector<double>& times);
+
+  /**
+   * Get the name of a complexity class, e.g. "O(n log n)".
+   */
+  static const char* name(Complexity complexity);
+
+  /**
+   * Write results in the passed format.
+   */
+  static void print(
+    std::ostream& out,
+    const std::vector<BenchmarkResult>& results,
+    Format format);
+
+  /**
+   * Write results and complexity fits in the passed format.
+   */
+  static void print(
+    std::ostream& out,
+    const std::vector<BenchmarkResult>& results,
+    const std::vector<ComplexityResult>& complexities,
+    Format format);
+
+  /**
+   * Get the format for a name, one of "text", "csv" or "json".
+   *
+   * @throws std::invalid_argument If the name is not known.
+   */
+  static Format format(const std::string& name);
+
+  /**
+   * Runs a command line application that lists and runs the registered
+   * benchmarks.  To be called from main().
+   */
+  static int main(int argc, char** argv);
+
+private:
+  struct Entry {
+    std::string name;
+    Function function;
+    RangeFunction range;
+    size_t from;
+    size_t to;
+  };
+
+  static std::vector<Entry>& registry();
+};
+
+} // namespace util
+} // namespace smack
+
+/**
+ * Defines and registers a benchmark.  The following block is the
+ * benchmark body that is executed once per iteration.
+ *
+ * SMACK_BENCHMARK(split) {
+ *   smack::util::do_not_optimize(smack::split("a,b,c", ","));
+ * }
+ */
+#define SMACK_BENCHMARK(NAME) \
+  static void smack_benchmark_body_##NAME(); \
+  static void smack_benchmark_loop_##NAME(size_t iterations) { \
+    for (size_t i = 0; i < iterations; i++) \
+      smack_benchmark_body_##NAME(); \
+  } \
+  static const bool smack_benchmark_registered_##NAME = \
+    ::smack::util::Benchmark::add(#NAME, &smack_benchmark_loop_##NAME); \
+  static void smack_benchmark_body_##NAME()
+
+/**
+ * Defines and registers a benchmark over a range of input sizes.  The
+ * following block is the benchmark body, n is the input size.  Prepare
+ * the input outside of the timed body, for example in a function-local
+ * static that is rebuilt when n changes.
+ *
+ * SMACK_BENCHMARK_RANGE(split_n, 64, 64 * 1024) {
+ *   static std::string input;
+ *   if (input.size() != n)
+ *     input = makeInput(n);
+ *   smack::util::do_not_optimize(smack::split(input, ","));
+ * }
+ */
+#define SMACK_BENCHMARK_RANGE(NAME, FROM, TO) \
+  static void smack_benchmark_body_##NAME(size_t n); \
+  static void smack_benchmark_loop_##NAME(size_t iterations, size_t n) { \
+    for (size_t i = 0; i < iterations; i++) \
+      smack_benchmark_body_##NAME(n); \
+  } \
+  static const bool smack_benchmark_registered_##NAME = \
+    ::smack::util::Benchmark::add(#NAME, &smack_benchmark_loop_##NAME, FROM, TO); \
+  static void smack_benchmark_body_##NAME(size_t n)
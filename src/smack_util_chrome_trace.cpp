@@ -0,0 +1,89 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Chrome trace event export.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#include <iomanip>
+#include <iostream>
+
+#include "smack_util_chrome_trace.hpp"
+
+namespace smack {
+namespace util {
+
+namespace {
+
+void writeJsonString(std::ostream& out, const char* in) {
+  out << '"';
+
+  for (; *in; in++) {
+    auto c = *in;
+    if (c == '"' || c == '\\')
+      out << '\\' << c;
+    else if (static_cast<unsigned char>(c) < 0x20)
+      out << ' ';
+    else
+      out << c;
+  }
+
+  out << '"';
+}
+
+} // namespace
+
+ChromeTrace::ChromeTrace(std::ostream& out)
+  : out_(out) {
+  out_ << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+}
+
+ChromeTrace::~ChromeTrace() {
+  close();
+}
+
+void ChromeTrace::add(unsigned thread, const char* name, double begin, double duration) {
+  if (closed_)
+    return;
+
+  // The stream belongs to the caller.
+  auto flags = out_.flags();
+  auto precision = out_.precision();
+
+  out_ << (first_ ? "\n" : ",\n") << "{\"name\":";
+  writeJsonString(out_, name);
+  out_ << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread
+    << std::fixed << std::setprecision(3)
+    << ",\"ts\":" << begin * 1e6
+    << ",\"dur\":" << duration * 1e6 << '}';
+  out_.flags(flags);
+  out_.precision(precision);
+
+  first_ = false;
+}
+
+void ChromeTrace::add(unsigned thread, const ZoneEvent& event) {
+  add(
+    thread,
+    event.name,
+    ZoneProfiler::seconds(event.begin),
+    ZoneProfiler::seconds(event.end - event.begin));
+}
+
+void ChromeTrace::collect() {
+  ZoneProfiler::collect([this](unsigned thread, const ZoneEvent& event) {
+    add(thread, event);
+  });
+}
+
+void ChromeTrace::close() {
+  if (closed_)
+    return;
+
+  out_ << "\n]}\n";
+  out_.flush();
+  closed_ = true;
+}
+
+} // namespace util
+} // namespace smack
@@ -0,0 +1,76 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Chrome trace event export.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+
+#include "smack_util_profiler.hpp"
+
+namespace smack {
+namespace util {
+
+/**
+ * Writes intervals as Chrome trace event JSON that can be loaded into
+ * Perfetto or chrome://tracing.  Events are written as they are added,
+ * the trace is never held in memory.
+ *
+ * std::ofstream file("trace.json");
+ * ChromeTrace trace(file);
+ * ...
+ * trace.collect();
+ */
+class ChromeTrace {
+  std::ostream& out_;
+  bool first_ = true;
+  bool closed_ = false;
+
+public:
+  /**
+   * Starts the trace.
+   */
+  explicit ChromeTrace(std::ostream& out);
+
+  /**
+   * Closes the trace.
+   */
+  ~ChromeTrace();
+
+  ChromeTrace(const ChromeTrace&) = delete;
+  ChromeTrace& operator=(const ChromeTrace&) = delete;
+
+  /**
+   * Add a complete interval.
+   *
+   * @param thread The thread id, see smack::thread_id().
+   * @param name The interval's name.
+   * @param begin The start time in seconds.
+   * @param duration The duration in seconds.
+   */
+  void add(unsigned thread, const char* name, double begin, double duration);
+
+  /**
+   * Add a zone recorded by the ZoneProfiler.
+   */
+  void add(unsigned thread, const ZoneEvent& event);
+
+  /**
+   * Drain the ZoneProfiler's buffers into the trace.  The zones are also
+   * added to the profiler's call tree.  Call periodically to keep the
+   * buffers from overflowing.
+   */
+  void collect();
+
+  /**
+   * Write the end of the trace.  Further events are ignored.
+   */
+  void close();
+};
+
+} // namespace util
+} // namespace smack
@@ -0,0 +1,125 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Latency histogram.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "smack_util_histogram.hpp"
+
+namespace smack {
+namespace util {
+
+uint64_t Histogram::lowest(size_t index) {
+  if (index < SUB_BUCKETS)
+    return index;
+
+  auto shift = index / HALF_SUB_BUCKETS - 1;
+
+  return uint64_t{ index - shift * HALF_SUB_BUCKETS } << shift;
+}
+
+uint64_t Histogram::highest(size_t index) {
+  if (index < SUB_BUCKETS)
+    return index;
+
+  auto shift = index / HALF_SUB_BUCKETS - 1;
+
+  return lowest(index) + ((uint64_t{ 1 } << shift) - 1);
+}
+
+Histogram::Snapshot::Snapshot()
+  : counts_(BUCKETS) {
+}
+
+void Histogram::Snapshot::record(uint64_t value, uint64_t count) {
+  counts_[index(value)] += count;
+  count_ += count;
+  sum_ += value * count;
+}
+
+void Histogram::Snapshot::merge(const Snapshot& other) {
+  for (size_t i = 0; i < BUCKETS; i++)
+    counts_[i] += other.counts_[i];
+  count_ += other.count_;
+  sum_ += other.sum_;
+}
+
+Histogram::Snapshot Histogram::Snapshot::since(const Snapshot& earlier) const {
+  Snapshot result;
+
+  for (size_t i = 0; i < BUCKETS; i++)
+    result.counts_[i] = counts_[i] - earlier.counts_[i];
+  result.count_ = count_ - earlier.count_;
+  result.sum_ = sum_ - earlier.sum_;
+
+  return result;
+}
+
+double Histogram::Snapshot::mean() const {
+  return count_ ? double(sum_) / count_ : 0.0;
+}
+
+uint64_t Histogram::Snapshot::min() const {
+  for (size_t i = 0; i < BUCKETS; i++) {
+    if (counts_[i])
+      return lowest(i);
+  }
+
+  return 0;
+}
+
+uint64_t Histogram::Snapshot::max() const {
+  for (size_t i = BUCKETS; i > 0; i--) {
+    if (counts_[i - 1])
+      return highest(i - 1);
+  }
+
+  return 0;
+}
+
+uint64_t Histogram::Snapshot::percentile(double fraction) const {
+  if (count_ == 0)
+    return 0;
+
+  // The rank of the value, at least the first one.
+  auto rank = std::max<uint64_t>(
+    1,
+    static_cast<uint64_t>(std::ceil(fraction * count_)));
+
+  uint64_t sum = 0;
+  for (size_t i = 0; i < BUCKETS; i++) {
+    sum += counts_[i];
+    if (sum >= rank)
+      return highest(i);
+  }
+
+  return max();
+}
+
+void Histogram::merge(const Snapshot& snapshot) {
+  for (size_t i = 0; i < BUCKETS; i++) {
+    if (snapshot.counts_[i])
+      counts_[i].fetch_add(snapshot.counts_[i], std::memory_order_relaxed);
+  }
+  sum_.fetch_add(snapshot.sum_, std::memory_order_relaxed);
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+  Snapshot result;
+
+  for (size_t i = 0; i < BUCKETS; i++) {
+    auto count = counts_[i].load(std::memory_order_relaxed);
+    result.counts_[i] = count;
+    result.count_ += count;
+  }
+  result.sum_ = sum_.load(std::memory_order_relaxed);
+
+  return result;
+}
+
+} // namespace util
+} // namespace smack
@@ -0,0 +1,187 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Latency histogram.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace smack {
+namespace util {
+
+/**
+ * A thread-safe HDR-style histogram of unsigned values, for example
+ * latencies in nanoseconds or microseconds.  The full 64 bit range is
+ * covered by log-linear buckets: values below 64 are counted exactly,
+ * each larger power of two is split into 32 buckets.  This bounds the
+ * relative error of a value to 1/32.  Recording is O(1) and lock-free,
+ * the memory is fixed at about 15KB.
+ *
+ * Queries are made on snapshots.  The difference of two snapshots
+ * covers the values recorded in between.
+ */
+class Histogram {
+public:
+  // Values below SUB_BUCKETS have their own bucket.
+  static constexpr unsigned SUB_BUCKET_BITS = 6;
+  static constexpr size_t SUB_BUCKETS = size_t{ 1 } << SUB_BUCKET_BITS;
+  static constexpr size_t HALF_SUB_BUCKETS = SUB_BUCKETS / 2;
+  static constexpr size_t BUCKETS = (64 - SUB_BUCKET_BITS + 2) * HALF_SUB_BUCKETS;
+
+  /**
+   * Get the position of the highest set bit of a value that is not zero.
+   */
+  static unsigned highestBit(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(value);
+#elif defined(_MSC_VER) && defined(_WIN64)
+    unsigned long result;
+    _BitScanReverse64(&result, value);
+    return result;
+#else
+    unsigned result = 0;
+    while (value >>= 1)
+      result++;
+    return result;
+#endif
+  }
+
+  /**
+   * Get the bucket of a value.
+   */
+  static size_t index(uint64_t value) {
+    if (value < SUB_BUCKETS)
+      return static_cast<size_t>(value);
+
+    unsigned msb = highestBit(value);
+    unsigned shift = msb - (SUB_BUCKET_BITS - 1);
+
+    return shift * HALF_SUB_BUCKETS + static_cast<size_t>(value >> shift);
+  }
+
+  /**
+   * Get the smallest value of a bucket.
+   */
+  static uint64_t lowest(size_t index);
+
+  /**
+   * Get the largest value of a bucket.
+   */
+  static uint64_t highest(size_t index);
+
+  /**
+   * A copy of the counts that can be queried and merged.  Not
+   * thread-safe.
+   */
+  class Snapshot {
+    std::vector<uint64_t> counts_;
+    uint64_t count_ = 0;
+    uint64_t sum_ = 0;
+
+    friend class Histogram;
+
+  public:
+    Snapshot();
+
+    /**
+     * Add a value.
+     */
+    void record(uint64_t value, uint64_t count = 1);
+
+    /**
+     * Add the values of another snapshot.
+     */
+    void merge(const Snapshot& other);
+
+    /**
+     * Get the values recorded since an earlier snapshot of the same
+     * histogram.
+     */
+    Snapshot since(const Snapshot& earlier) const;
+
+    /**
+     * @return The number of values.
+     */
+    uint64_t count() const {
+      return count_;
+    }
+
+    /**
+     * @return The count of a bucket.
+     */
+    uint64_t count(size_t index) const {
+      return counts_[index];
+    }
+
+    /**
+     * @return The sum of the values.
+     */
+    uint64_t sum() const {
+      return sum_;
+    }
+
+    /**
+     * @return The exact mean of the values, zero if empty.
+     */
+    double mean() const;
+
+    /**
+     * @return The lower bound of the smallest value's bucket, zero if
+     * empty.
+     */
+    uint64_t min() const;
+
+    /**
+     * @return The upper bound of the largest value's bucket, zero if
+     * empty.
+     */
+    uint64_t max() const;
+
+    /**
+     * Get the upper bound of the bucket that holds the passed fraction
+     * of the values.
+     *
+     * @param fraction The fraction in the range [0.0, 1.0], for example
+     * 0.99 for the 99th percentile.
+     * @return The percentile, zero if empty.
+     */
+    uint64_t percentile(double fraction) const;
+  };
+
+  /**
+   * Add a value.  Can be called concurrently from any thread.
+   */
+  void record(uint64_t value) {
+    counts_[index(value)].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  /**
+   * Add the values of a snapshot.
+   */
+  void merge(const Snapshot& snapshot);
+
+  /**
+   * Get a snapshot of the recorded values.  Values recorded
+   * concurrently may or may not be included.
+   */
+  Snapshot snapshot() const;
+
+private:
+  std::array<std::atomic<uint64_t>, BUCKETS> counts_{};
+  std::atomic<uint64_t> sum_{ 0 };
+};
+
+} // namespace util
+} // namespace smack
@@ -0,0 +1,137 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Hardware performance counters.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#include "smack_util_perf_counters.hpp"
+
+#if defined(__linux__)
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace smack {
+namespace util {
+
+#if defined(__linux__)
+
+namespace {
+
+constexpr uint64_t events[] = {
+  PERF_COUNT_HW_CPU_CYCLES,
+  PERF_COUNT_HW_INSTRUCTIONS,
+  PERF_COUNT_HW_CACHE_MISSES,
+  PERF_COUNT_HW_BRANCH_MISSES
+};
+
+int open(uint64_t config, int group) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  attr.disabled = group < 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format =
+    PERF_FORMAT_GROUP |
+    PERF_FORMAT_TOTAL_TIME_ENABLED |
+    PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  return static_cast<int>(
+    syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+}
+
+} // namespace
+
+PerfCounters::PerfCounters() {
+  for (auto& fd : fds_)
+    fd = -1;
+
+  for (int i = 0; i < 4; i++) {
+    fds_[i] = open(events[i], i ? fds_[0] : -1);
+
+    // All or nothing.
+    if (fds_[i] < 0) {
+      for (int j = 0; j < i; j++) {
+        ::close(fds_[j]);
+        fds_[j] = -1;
+      }
+      return;
+    }
+  }
+}
+
+PerfCounters::~PerfCounters() {
+  for (auto fd : fds_) {
+    if (fd >= 0)
+      ::close(fd);
+  }
+}
+
+void PerfCounters::start() {
+  if (!available())
+    return;
+
+  ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void PerfCounters::stop() {
+  if (!available())
+    return;
+
+  ioctl(fds_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+}
+
+PerfCounterValues PerfCounters::read() const {
+  PerfCounterValues result;
+
+  if (!available())
+    return result;
+
+  // nr, time_enabled, time_running, values[nr]
+  uint64_t buffer[3 + 4];
+  if (::read(fds_[0], buffer, sizeof(buffer)) != sizeof(buffer) || buffer[0] != 4)
+    return result;
+
+  double scale = buffer[2] ? double(buffer[1]) / buffer[2] : 0.0;
+
+  result.valid = buffer[2] > 0;
+  result.cycles = buffer[3] * scale;
+  result.instructions = buffer[4] * scale;
+  result.cacheMisses = buffer[5] * scale;
+  result.branchMisses = buffer[6] * scale;
+
+  return result;
+}
+
+#else
+
+PerfCounters::PerfCounters() {
+  for (auto& fd : fds_)
+    fd = -1;
+}
+
+PerfCounters::~PerfCounters() {
+}
+
+void PerfCounters::start() {
+}
+
+void PerfCounters::stop() {
+}
+
+PerfCounterValues PerfCounters::read() const {
+  return {};
+}
+
+#endif
+
+} // namespace util
+} // namespace smack
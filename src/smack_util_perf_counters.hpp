@@ -0,0 +1,82 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Hardware performance counters.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace smack {
+namespace util {
+
+/**
+ * The values of the hardware performance counters.
+ */
+struct PerfCounterValues {
+  // true if the counters were measured.
+  bool valid = false;
+  double cycles = 0.0;
+  double instructions = 0.0;
+  double cacheMisses = 0.0;
+  double branchMisses = 0.0;
+
+  /**
+   * @return The instructions per cycle, zero if no cycles were counted.
+   */
+  double ipc() const {
+    return cycles > 0.0 ? instructions / cycles : 0.0;
+  }
+};
+
+/**
+ * A group of hardware performance counters for the calling thread:
+ * cycles, instructions, cache misses and branch misses.  Uses
+ * perf_event_open on Linux and counts user space only.  If the kernel
+ * refuses access, e.g. because of /proc/sys/kernel/perf_event_paranoid,
+ * or on other platforms the counters are not available and read()
+ * returns invalid values.
+ */
+class PerfCounters {
+  // The file descriptors of the counters, the first is the group leader.
+  int fds_[4];
+
+public:
+  /**
+   * Opens the counter group.  The counters are stopped.
+   */
+  PerfCounters();
+
+  ~PerfCounters();
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  /**
+   * @return true if the counters could be opened.
+   */
+  bool available() const {
+    return fds_[0] >= 0;
+  }
+
+  /**
+   * Reset the counters to zero and start counting.
+   */
+  void start();
+
+  /**
+   * Stop counting.
+   */
+  void stop();
+
+  /**
+   * Read the counters.  Values are scaled up if the kernel had to
+   * multiplex the counters.
+   */
+  PerfCounterValues read() const;
+};
+
+} // namespace util
+} // namespace smack
@@ -0,0 +1,218 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Hierarchical zone profiler.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+#include "smack_util.hpp"
+#include "smack_util_profiler.hpp"
+
+namespace smack {
+namespace util {
+
+namespace {
+
+/**
+ * The buffers of all threads, the call tree and the lock for
+ * collecting.
+ */
+struct Registry {
+  std::mutex mutex;
+  std::vector<std::shared_ptr<ZoneBuffer>> buffers;
+  ZoneNode root;
+};
+
+Registry& registry() {
+  static Registry result;
+  return result;
+}
+
+/**
+ * Closes the thread's buffer when the thread exits.
+ */
+struct Holder {
+  std::shared_ptr<ZoneBuffer> buffer;
+
+  ~Holder() {
+    if (buffer)
+      buffer->close();
+  }
+};
+
+thread_local Holder holder;
+
+void print(std::ostream& out, const ZoneNode& node, int depth) {
+  out << std::left << std::setw(40)
+    << (std::string(2 * depth, ' ') + node.name)
+    << std::right << std::fixed
+    << std::setw(12) << node.calls
+    << std::setprecision(3)
+    << std::setw(16) << node.inclusive * 1e3
+    << std::setw(16) << node.exclusive() * 1e3 << '\n';
+
+  for (const auto& child : node.children)
+    print(out, child, depth + 1);
+}
+
+} // namespace
+
+thread_local ZoneBuffer* ZoneProfiler::local_ = nullptr;
+
+double ZoneNode::exclusive() const {
+  double result = inclusive;
+
+  for (const auto& c : children)
+    result -= c.inclusive;
+
+  return result;
+}
+
+ZoneNode& ZoneNode::child(const char* name) {
+  for (auto& c : children) {
+    if (c.name == name || std::strcmp(c.name, name) == 0)
+      return c;
+  }
+
+  children.push_back({ name, 0, 0.0, {} });
+  return children.back();
+}
+
+const ZoneNode* ZoneNode::find(const char* name) const {
+  for (const auto& c : children) {
+    if (std::strcmp(c.name, name) == 0)
+      return &c;
+  }
+
+  return nullptr;
+}
+
+void ZoneNode::merge(const ZoneNode& other) {
+  calls += other.calls;
+  inclusive += other.inclusive;
+
+  for (const auto& c : other.children)
+    child(c.name).merge(c);
+}
+
+ZoneBuffer* ZoneProfiler::attach() {
+  auto buffer = std::make_shared<ZoneBuffer>(thread_id());
+
+  {
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.buffers.push_back(buffer);
+  }
+
+  holder.buffer = buffer;
+  local_ = buffer.get();
+
+  return local_;
+}
+
+ZoneNode ZoneProfiler::collect() {
+  return collect(nullptr);
+}
+
+double ZoneProfiler::seconds(uint64_t ticks) {
+  return ticks / (tsc() ? TscClock::ticks_per_second() : 1e9);
+}
+
+ZoneNode ZoneProfiler::collect(const Visitor& visitor) {
+  auto& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+
+  for (auto it = r.buffers.begin(); it != r.buffers.end();) {
+    auto& buffer = **it;
+
+    // Read closed first, so that all events of a closed buffer are seen.
+    bool closed = buffer.closed_.load(std::memory_order_acquire);
+    auto head = buffer.head_.load(std::memory_order_acquire);
+    auto tail = buffer.tail_.load(std::memory_order_relaxed);
+
+    auto& pending = buffer.pending_;
+
+    for (; tail != head; tail++) {
+      const auto& event = buffer.events_[tail % ZoneBuffer::CAPACITY];
+
+      if (visitor)
+        visitor(buffer.thread_, event);
+
+      // Discard the children of dropped zones.
+      for (auto depth = event.orphaned; depth < pending.size(); depth++)
+        pending[depth].children.clear();
+
+      if (pending.size() < event.depth + 2u)
+        pending.resize(event.depth + 2u);
+
+      // The completed children of this zone are waiting one level below.
+      ZoneNode node{ event.name, 1, seconds(event.end - event.begin), {} };
+      node.children.swap(pending[event.depth + 1].children);
+
+      if (event.depth == 0)
+        r.root.child(node.name).merge(node);
+      else
+        pending[event.depth].child(node.name).merge(node);
+    }
+
+    buffer.tail_.store(tail, std::memory_order_release);
+
+    if (closed)
+      it = r.buffers.erase(it);
+    else
+      ++it;
+  }
+
+  return r.root;
+}
+
+uint64_t ZoneProfiler::dropped() {
+  auto& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+
+  uint64_t result = 0;
+  for (const auto& buffer : r.buffers)
+    result += buffer->dropped_.load(std::memory_order_relaxed);
+
+  return result;
+}
+
+void ZoneProfiler::reset() {
+  collect();
+
+  auto& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+
+  r.root = ZoneNode{};
+  for (const auto& buffer : r.buffers)
+    buffer->dropped_.store(0, std::memory_order_relaxed);
+}
+
+void ZoneProfiler::report(std::ostream& out) {
+  auto root = collect();
+
+  // The stream belongs to the caller.
+  auto flags = out.flags();
+  auto precision = out.precision();
+
+  out << std::left << std::setw(40) << "zone"
+    << std::right
+    << std::setw(12) << "calls"
+    << std::setw(16) << "inclusive ms"
+    << std::setw(16) << "exclusive ms" << '\n';
+
+  for (const auto& child : root.children)
+    print(out, child, 0);
+
+  out.flags(flags);
+  out.precision(precision);
+}
+
+} // namespace util
+} // namespace smack
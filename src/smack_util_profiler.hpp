@@ -0,0 +1,274 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Hierarchical zone profiler.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <vector>
+
+#include "smack_util_time_probe.hpp"
+
+namespace smack {
+namespace util {
+
+/**
+ * A node of the call tree built by the ZoneProfiler.  Times are in
+ * seconds.  Zones with equal names below the same parent are merged.
+ */
+struct ZoneNode {
+  // The zone name, nullptr for the root.
+  const char* name = nullptr;
+  uint64_t calls = 0;
+  // The time spent in the zone including its child zones.
+  double inclusive = 0.0;
+  std::vector<ZoneNode> children;
+
+  /**
+   * @return The time spent in the zone excluding its child zones.
+   */
+  double exclusive() const;
+
+  /**
+   * Get the child with the passed name, added if it does not exist.
+   */
+  ZoneNode& child(const char* name);
+
+  /**
+   * Get the child with the passed name.
+   *
+   * @return The child or nullptr if it does not exist.
+   */
+  const ZoneNode* find(const char* name) const;
+
+  /**
+   * Add the calls, times and children of another node with the same
+   * name.
+   */
+  void merge(const ZoneNode& other);
+};
+
+/**
+ * A zone completed by a thread.  Recorded when the zone ends, so child
+ * zones precede their parent.
+ */
+struct ZoneEvent {
+  // The orphaned value if no events were dropped before this one.
+  static constexpr uint32_t NONE = UINT32_MAX;
+
+  const char* name;
+  uint64_t begin;
+  uint64_t end;
+  uint32_t depth;
+  // The smallest depth whose waiting child zones lost their parent
+  // because it was dropped before this event.
+  uint32_t orphaned;
+};
+
+/**
+ * The per thread ring buffer of completed zones.  Written by its thread
+ * and read by the ZoneProfiler without locks.  If the buffer is full,
+ * events are dropped.
+ */
+class ZoneBuffer {
+public:
+  static constexpr size_t CAPACITY = 1 << 14;
+
+  /**
+   * The nesting depth of the thread's open zones.  Only accessed by the
+   * owning thread.
+   */
+  uint32_t depth_ = 0;
+
+  /**
+   * The smack::thread_id() of the owning thread.
+   */
+  const unsigned thread_;
+
+  explicit ZoneBuffer(unsigned thread)
+    : thread_(thread) {
+  }
+
+  /**
+   * Record a completed zone.  Called by the owning thread.
+   */
+  void push(const char* name, uint64_t begin, uint64_t end, uint32_t depth) {
+    auto head = head_.load(std::memory_order_relaxed);
+
+    if (head - tail_.load(std::memory_order_acquire) >= CAPACITY) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      // The already recorded children of the zone are orphaned.
+      if (depth + 1 < orphaned_)
+        orphaned_ = depth + 1;
+      return;
+    }
+
+    events_[head % CAPACITY] = { name, begin, end, depth, orphaned_ };
+    orphaned_ = ZoneEvent::NONE;
+    head_.store(head + 1, std::memory_order_release);
+  }
+
+  /**
+   * Mark the buffer as closed when the owning thread exits.  The
+   * ZoneProfiler releases it after draining.
+   */
+  void close() {
+    closed_.store(true, std::memory_order_release);
+  }
+
+private:
+  friend class ZoneProfiler;
+
+  // The orphaned depth for the next recorded event.  Only accessed by
+  // the owning thread.
+  uint32_t orphaned_ = ZoneEvent::NONE;
+
+  ZoneEvent events_[CAPACITY];
+  std::atomic<uint64_t> head_{ 0 };
+  std::atomic<uint64_t> tail_{ 0 };
+  std::atomic<uint64_t> dropped_{ 0 };
+  // Set when the owning thread has exited.
+  std::atomic<bool> closed_{ false };
+  // The merged subtrees of completed zones by depth, waiting for their
+  // parent to complete.  Only accessed by the ZoneProfiler.
+  std::vector<ZoneNode> pending_;
+};
+
+/**
+ * Collects the zones recorded by all threads into a call tree.
+ */
+class ZoneProfiler {
+public:
+  /**
+   * Receives the zones drained from the buffers together with the
+   * smack::thread_id() of the recording thread.
+   */
+  using Visitor = std::function<void(unsigned thread, const ZoneEvent&)>;
+
+  /**
+   * Get the calling thread's buffer.
+   */
+  static ZoneBuffer& local() {
+    auto result = local_;
+    if (result == nullptr)
+      result = attach();
+    return *result;
+  }
+
+  /**
+   * Get the current time in ticks.  Uses the TscClock if available.
+   */
+  static uint64_t now() {
+    if (tsc())
+      return TscClock::now();
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  /**
+   * Drain the buffers of all threads and add their zones to the call
+   * tree.  Zones that are still open are added when they complete.
+   *
+   * @return The call tree of all zones completed so far.
+   */
+  static ZoneNode collect();
+
+  /**
+   * Like collect(), additionally passes each drained zone to the
+   * visitor.  The visitor is called under the profiler's lock and must
+   * not collect.
+   */
+  static ZoneNode collect(const Visitor& visitor);
+
+  /**
+   * Convert a duration in ticks as returned by now() to seconds.
+   */
+  static double seconds(uint64_t ticks);
+
+  /**
+   * @return The number of zones dropped because a buffer was full.
+   */
+  static uint64_t dropped();
+
+  /**
+   * Discard the collected call tree and the buffered zones.
+   */
+  static void reset();
+
+  /**
+   * Collect and write the call tree with the calls, inclusive and
+   * exclusive times per zone.
+   */
+  static void report(std::ostream& out);
+
+private:
+  static bool tsc() {
+    static const bool result = TscClock::available();
+    return result;
+  }
+
+  static ZoneBuffer* attach();
+
+  static thread_local ZoneBuffer* local_;
+};
+
+/**
+ * Profiles the enclosing scope.  Use the SMACK_ZONE macro, so that the
+ * zones can be compiled out.  The name must be a string literal.
+ */
+class Zone {
+  const char* name_;
+  ZoneBuffer& buffer_;
+  uint32_t depth_;
+  uint64_t begin_;
+
+public:
+  template <size_t N>
+  explicit Zone(const char (&name)[N])
+    : name_(name),
+      buffer_(ZoneProfiler::local()),
+      depth_(buffer_.depth_++),
+      begin_(ZoneProfiler::now()) {
+  }
+
+  ~Zone() {
+    auto end = ZoneProfiler::now();
+    buffer_.depth_--;
+    buffer_.push(name_, begin_, end, depth_);
+  }
+
+  Zone(const Zone&) = delete;
+  Zone& operator=(const Zone&) = delete;
+};
+
+} // namespace util
+} // namespace smack
+
+#define SMACK_ZONE_CONCAT_(A, B) A##B
+#define SMACK_ZONE_CONCAT(A, B) SMACK_ZONE_CONCAT_(A, B)
+
+/**
+ * Profiles the enclosing scope under the passed name.  Compiled out if
+ * SMACK_ZONES_DISABLED is defined.
+ *
+ * void parse() {
+ *   SMACK_ZONE("parse");
+ *   ...
+ * }
+ */
+#if defined(SMACK_ZONES_DISABLED)
+#define SMACK_ZONE(NAME) do {} while (false)
+#else
+#define SMACK_ZONE(NAME) \
+  ::smack::util::Zone SMACK_ZONE_CONCAT(smack_zone_, __LINE__){ NAME }
+#endif
@@ -5,10 +5,17 @@
  * Copyright © 2019 Michael Binz
  */
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <numeric>
 
 #include "smack_util_time_probe.hpp"
 
+#if SMACK_HAVE_TSC && (defined(__GNUC__) || defined(__clang__))
+#include <cpuid.h>
+#endif
+
 namespace smack {
 namespace util {
 
@@ -41,5 +48,141 @@ void TimeProbe::toString() {
   std::cout << a_message << ": " << duration() << "sec" << std::endl;
 }
 
+namespace {
+
+#if SMACK_HAVE_TSC
+/**
+ * Execute the cpuid instruction.
+ *
+ * @return false if the leaf is not supported.
+ */
+bool cpuid(unsigned int leaf, unsigned int regs[4]) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __get_cpuid(leaf, &regs[0], &regs[1], &regs[2], &regs[3]) != 0;
+#else
+  int info[4];
+  __cpuid(info, leaf & 0x80000000);
+  if (static_cast<unsigned int>(info[0]) < leaf)
+    return false;
+  __cpuid(info, leaf);
+  for (int i = 0; i < 4; i++)
+    regs[i] = static_cast<unsigned int>(info[i]);
+  return true;
+#endif
+}
+
+bool detectTsc() {
+  unsigned int regs[4];
+
+  // rdtscp is EDX bit 27 of leaf 0x80000001.
+  if (!cpuid(0x80000001, regs) || !(regs[3] & (1u << 27)))
+    return false;
+
+  // The invariant TSC is EDX bit 8 of leaf 0x80000007.
+  return cpuid(0x80000007, regs) && (regs[3] & (1u << 8));
+}
+
+double calibrateTsc() {
+  using clock = std::chrono::steady_clock;
+
+  auto start = clock::now();
+  auto ticks = TscClock::start();
+
+  auto end = start;
+  while (end - start < std::chrono::milliseconds(20))
+    end = clock::now();
+
+  auto elapsed = TscClock::stop() - ticks;
+
+  return elapsed / std::chrono::duration<double>(end - start).count();
+}
+#endif
+
+/**
+ * Get a percentile from sorted samples using the nearest rank.
+ */
+double percentile(const std::vector<double>& sorted, double fraction) {
+  auto rank = static_cast<size_t>(std::ceil(fraction * sorted.size()));
+
+  return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+} // namespace
+
+bool TscClock::available() {
+#if SMACK_HAVE_TSC
+  static const bool result = detectTsc();
+  return result;
+#else
+  return false;
+#endif
+}
+
+double TscClock::ticks_per_second() {
+#if SMACK_HAVE_TSC
+  static const double result = available() ? calibrateTsc() : 0.0;
+  return result;
+#else
+  return 0.0;
+#endif
+}
+
+std::vector<unsigned int> TimeProbe::default_threads() {
+  auto hardware = std::max(1u, std::thread::hardware_concurrency());
+
+  std::vector<unsigned int> result;
+  for (unsigned int count = 1; count < hardware; count *= 2)
+    result.push_back(count);
+  result.push_back(hardware);
+
+  return result;
+}
+
+PerfCounterValues TimeProbe::perCall(PerfCounterValues values, unsigned int times) {
+  values.cycles /= times;
+  values.instructions /= times;
+  values.cacheMisses /= times;
+  values.branchMisses /= times;
+  return values;
+}
+
+ProfileResult TimeProbe::evaluate(std::vector<double>& samples) {
+  ProfileResult result;
+
+  if (samples.empty())
+    return result;
+
+  std::sort(samples.begin(), samples.end());
+
+  auto n = samples.size();
+
+  result.samples = n;
+  result.min = samples.front();
+  result.max = samples.back();
+  result.mean =
+    std::accumulate(samples.begin(), samples.end(), 0.0) / n;
+  result.median = n % 2
+    ? samples[n / 2]
+    : (samples[n / 2 - 1] + samples[n / 2]) / 2.0;
+  result.p90 = percentile(samples, 0.90);
+  result.p99 = percentile(samples, 0.99);
+  result.p999 = percentile(samples, 0.999);
+
+  double squares = 0.0;
+  for (auto sample : samples)
+    squares += (sample - result.mean) * (sample - result.mean);
+  result.stddev = std::sqrt(squares / n);
+
+  auto q1 = percentile(samples, 0.25);
+  auto q3 = percentile(samples, 0.75);
+  auto fence = 1.5 * (q3 - q1);
+  for (auto sample : samples) {
+    if (sample < q1 - fence || sample > q3 + fence)
+      result.outliers++;
+  }
+
+  return result;
+}
+
 } // namepace util
 } // namespace smack
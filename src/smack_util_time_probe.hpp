@@ -11,12 +11,169 @@
 #include <thread>
 #include <vector>
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
 #include <numeric>
+#include <optional>
+
+#include "smack_util_allocations.hpp"
+#include "smack_util_perf_counters.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define SMACK_HAVE_TSC 1
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define SMACK_HAVE_TSC 1
+#else
+#define SMACK_HAVE_TSC 0
+#endif
 
 namespace smack {
 namespace util {
 
+/**
+ * Reads the CPU's time stamp counter.  Much cheaper than reading a chrono
+ * clock, which matters when measuring code that runs for less than
+ * 100ns.  Only usable if available() returns true, that is on x86 with an
+ * invariant TSC that ticks at a constant rate independent of frequency
+ * scaling.  Note that the ticks are reference cycles at the nominal
+ * frequency, not core cycles.
+ */
+class TscClock {
+public:
+  /**
+   * Check if the CPU offers an invariant TSC and rdtscp.
+   */
+  static bool available();
+
+  /**
+   * Get the TSC ticks per second.  Calibrated against steady_clock on
+   * the first call, which takes about 20ms.
+   */
+  static double ticks_per_second();
+
+  /**
+   * Read the counter without ordering it against other instructions.
+   * The cheapest read, for instrumentation that records many intervals.
+   */
+  static uint64_t now() {
+#if SMACK_HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+  }
+
+  /**
+   * Read the counter at the start of a measurement.  Earlier
+   * instructions finish before and later ones start after the read.
+   */
+  static uint64_t start() {
+#if SMACK_HAVE_TSC
+    _mm_lfence();
+    uint64_t result = __rdtsc();
+    _mm_lfence();
+    return result;
+#else
+    return 0;
+#endif
+  }
+
+  /**
+   * Read the counter at the end of a measurement.  Waits for the measured
+   * instructions to finish.
+   */
+  static uint64_t stop() {
+#if SMACK_HAVE_TSC
+    unsigned int aux;
+    uint64_t result = __rdtscp(&aux);
+    _mm_lfence();
+    return result;
+#else
+    return 0;
+#endif
+  }
+};
+
+/**
+ * The clock used for profiling.
+ */
+enum class ProfileClock {
+  // std::chrono::high_resolution_clock.
+  Chrono,
+  // The TscClock, falls back to Chrono if the TSC is not available.
+  Tsc
+};
+
+/**
+ * The counters recorded while profiling.
+ */
+enum class ProfileCounters {
+  // Time only.
+  None,
+  // Also the hardware performance counters, if available.
+  Hardware
+};
+
+/**
+ * The statistics of a profiling run.  All times are in seconds.
+ */
+struct ProfileResult {
+  // The number of samples.
+  size_t samples = 0;
+  double min = 0.0;
+  double max = 0.0;
+  double mean = 0.0;
+  double median = 0.0;
+  double p90 = 0.0;
+  double p99 = 0.0;
+  double p999 = 0.0;
+  // The standard deviation.
+  double stddev = 0.0;
+  // The number of samples outside of the Tukey fences, that is, more
+  // than 1.5 times the interquartile range below the first or above the
+  // third quartile.
+  size_t outliers = 0;
+  // The TSC ticks per second if the samples were taken with the
+  // TscClock, otherwise zero.
+  double ticksPerSecond = 0.0;
+  // The per iteration averages of the hardware performance counters.
+  // Includes the overhead of the time measurement.
+  PerfCounterValues counters;
+  // The per iteration averages of operator new calls and requested
+  // bytes.  Zero unless the SMACK_ALLOCATION_HOOK is installed.
+  double allocations = 0.0;
+  double allocatedBytes = 0.0;
+
+  /**
+   * Convert a time of this result to TSC cycles.
+   *
+   * @return The cycles, zero if the TscClock was not used.
+   */
+  double cycles(double seconds) const {
+    return seconds * ticksPerSecond;
+  }
+};
+
+/**
+ * The result of profiling a lambda on a number of concurrent threads.
+ */
+struct ScalingResult {
+  unsigned threads = 0;
+  // The calls per thread.
+  unsigned times = 0;
+  // The wall time from the release of the threads until the last one
+  // finished.
+  double seconds = 0.0;
+  // The calls per second of all threads.
+  double throughput = 0.0;
+  // The throughput per thread relative to the first thread count in
+  // the profile.  1.0 is perfect scaling.
+  double efficiency = 0.0;
+};
+
 /**
  * Allows in-program time measurements. Internally uses hi-res timers.
  */
@@ -110,6 +267,179 @@ public:
       averageCount;
   }
 
+  /**
+   * Performs times executions of the passed lambda and computes the
+   * statistics of the recorded times.
+   *
+   * @param times The number of executions to be measured.
+   * @param lambda The lambda to execute.
+   * @param samples The buffer for the samples.  Its capacity is reused,
+   *        pass the same buffer to avoid allocations in repeated runs.
+   *        Holds the sorted samples on return.
+   * @param clock The clock used for the measurement.
+   * @param counters The counters recorded in addition to the time.
+   * @return The statistics of the execution times.
+   */
+  template <typename L>
+  static ProfileResult profile_statistics(
+    unsigned int times,
+    L lambda,
+    std::vector<double>& samples,
+    ProfileClock clock = ProfileClock::Chrono,
+    ProfileCounters counters = ProfileCounters::None) {
+    samples.clear();
+    samples.reserve(times);
+
+    // Opening the counters takes several syscalls.
+    std::optional<PerfCounters> perf;
+    if (counters == ProfileCounters::Hardware) {
+      perf.emplace();
+      perf->start();
+    }
+
+    double ticksPerSecond = 0.0;
+    auto allocated = AllocationCounter::current();
+
+    if (clock == ProfileClock::Tsc && TscClock::available()) {
+      ticksPerSecond = TscClock::ticks_per_second();
+
+      for (unsigned int i = 0; i < times; i++) {
+        auto start = TscClock::start();
+        lambda();
+        auto end = TscClock::stop();
+        samples.push_back((end - start) / ticksPerSecond);
+      }
+    }
+    else {
+      TimeProbe tp("profile");
+
+      for (unsigned int i = 0; i < times; i++) {
+        tp.reset();
+        lambda();
+        samples.push_back(tp.duration());
+      }
+    }
+
+    if (perf)
+      perf->stop();
+    auto allocatedEnd = AllocationCounter::current();
+
+    auto result = evaluate(samples);
+    if (times) {
+      result.allocations =
+        double(allocatedEnd.allocations - allocated.allocations) / times;
+      result.allocatedBytes =
+        double(allocatedEnd.bytes - allocated.bytes) / times;
+    }
+    result.ticksPerSecond = ticksPerSecond;
+    if (perf && times)
+      result.counters = perCall(perf->read(), times);
+    return result;
+  }
+
+  /**
+   * Performs times executions of the passed lambda and computes the
+   * statistics of the recorded times.
+   *
+   * @param times The number of executions to be measured.
+   * @param lambda The lambda to execute.
+   * @param clock The clock used for the measurement.
+   * @param counters The counters recorded in addition to the time.
+   * @return The statistics of the execution times.
+   */
+  template <typename L>
+  static ProfileResult profile_statistics(
+    unsigned int times,
+    L lambda,
+    ProfileClock clock = ProfileClock::Chrono,
+    ProfileCounters counters = ProfileCounters::None) {
+    std::vector<double> samples;
+
+    return profile_statistics(times, lambda, samples, clock, counters);
+  }
+
+  /**
+   * @return The thread counts 1, 2, 4, ... up to the number of hardware
+   * threads, which is included.
+   */
+  static std::vector<unsigned int> default_threads();
+
+  /**
+   * Measures how the throughput of the passed lambda scales with the
+   * number of threads executing it concurrently.  For each thread count
+   * the threads are started and wait at a barrier, then they are
+   * released together and each executes the lambda times times.
+   *
+   * @param times The number of executions per thread.
+   * @param lambda The lambda to execute.  Called concurrently.
+   * @param threads The thread counts to profile.
+   * @return The results in the order of the thread counts.
+   */
+  template <typename L>
+  static std::vector<ScalingResult> profile_scaling(
+    unsigned int times,
+    L lambda,
+    const std::vector<unsigned int>& threads = default_threads()) {
+    std::vector<ScalingResult> result;
+
+    for (auto count : threads) {
+      if (count == 0)
+        continue;
+
+      std::atomic<unsigned int> ready{ 0 };
+      std::atomic<bool> go{ false };
+
+      std::vector<std::thread> workers;
+      workers.reserve(count);
+      for (unsigned int i = 0; i < count; i++) {
+        workers.emplace_back([&ready, &go, &lambda, times]() {
+          ready.fetch_add(1);
+          while (!go.load(std::memory_order_acquire))
+            std::this_thread::yield();
+          for (unsigned int j = 0; j < times; j++)
+            lambda();
+        });
+      }
+
+      while (ready.load() < count)
+        std::this_thread::yield();
+
+      TimeProbe tp("profile_scaling");
+      go.store(true, std::memory_order_release);
+      for (auto& worker : workers)
+        worker.join();
+
+      ScalingResult r;
+      r.threads = count;
+      r.times = times;
+      r.seconds = tp.duration();
+      r.throughput = r.seconds > 0.0 ? double(count) * times / r.seconds : 0.0;
+      result.push_back(r);
+    }
+
+    if (result.empty())
+      return result;
+
+    double base = result.front().throughput / result.front().threads;
+    for (auto& r : result)
+      r.efficiency = base > 0.0 ? r.throughput / r.threads / base : 0.0;
+
+    return result;
+  }
+
+  /**
+   * Computes the statistics of a set of samples.
+   *
+   * @param samples The samples.  These are sorted in place.
+   * @return The statistics.
+   */
+  static ProfileResult evaluate(std::vector<double>& samples);
+
+  /**
+   * Divides counter values by the number of calls.
+   */
+  static PerfCounterValues perCall(PerfCounterValues values, unsigned int times);
+
   /**
    * Profiles the passed lambda.
    *
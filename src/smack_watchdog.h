@@ -0,0 +1,339 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Timeouts for thread pool tasks.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "smack_common.h"
+#include "smack_scheduler.h"
+#include "smack_threadpool.h"
+
+namespace smack {
+
+/**
+ * Executes tasks on a thread pool with a timeout.  All running tasks
+ * share a single scheduler timer that is armed for the earliest
+ * deadline.  When a task's deadline passes, its cancellation state is
+ * set and its timeout callback is called.  Cancellation is cooperative,
+ * the task has to check its cancellation state.
+ *
+ * Since all tasks use the same timeout, the armed tasks are kept in
+ * deadline order in an intrusive list.  Arming and disarming a task is
+ * O(1).  The watch of a finished task is reused, so that arming does not
+ * allocate once as many tasks as run concurrently were executed.  The
+ * shared timer is only scheduled when the list was empty or the timer
+ * expired, each of which allocates a scheduler entry.
+ *
+ * The watchdog may be destroyed while tasks are still running.
+ */
+class Watchdog {
+public:
+    /**
+     * The cancellation state of a task.
+     */
+    class Cancellation {
+        friend class Watchdog;
+
+        std::atomic<bool> cancelled_ = false;
+
+    public:
+        /**
+         * Check if the task's deadline passed.
+         */
+        auto isCancelled() const -> bool
+        {
+            return cancelled_.load(std::memory_order_relaxed);
+        }
+    };
+
+    /**
+     * A task that can check its cancellation state.
+     */
+    using TASK = std::function<void(const Cancellation&)>;
+
+private:
+    /**
+     * A submitted task.  Linked into the list of armed tasks while the
+     * task is pending or running, kept for reuse when it finished.
+     */
+    struct State;
+
+    struct Watch : Cancellation {
+        // Keeps the state alive while the task runs.
+        std::shared_ptr<State> state_;
+        Watch* prev_ = nullptr;
+        Watch* next_ = nullptr;
+        bool armed_ = false;
+        TimePoint deadline_;
+        TASK task_;
+        THUNK onTimeout_;
+    };
+
+    struct State {
+        std::mutex mutex_;
+        Scheduler& scheduler_;
+        Duration timeout_;
+        // The armed tasks in deadline order.
+        Watch* head_ = nullptr;
+        Watch* tail_ = nullptr;
+        // The finished watches for reuse, linked by next_.
+        Watch* free_ = nullptr;
+        bool timerPending_ = false;
+        bool closed_ = false;
+
+        State( Scheduler& scheduler, Duration timeout )
+            : scheduler_{scheduler}
+            , timeout_{timeout}
+        {
+        }
+
+        State(const State&) = delete;
+        State& operator=(const State&) = delete;
+
+        ~State()
+        {
+            while (free_) {
+                auto next = free_->next_;
+                delete free_;
+                free_ = next;
+            }
+        }
+
+        /**
+         * Get a finished watch or a new one.  Called under the lock.
+         */
+        auto acquire() -> Watch*
+        {
+            if (free_ == nullptr) {
+                return new Watch;
+            }
+
+            auto result = free_;
+            free_ = result->next_;
+            result->cancelled_ = false;
+
+            return result;
+        }
+
+        /**
+         * Disarm a finished watch and keep it for reuse.  Its task and
+         * timeout callback are passed out, so that they are destroyed
+         * outside of the lock.  Called under the lock.
+         */
+        auto recycle( Watch* watch, TASK& task, THUNK& onTimeout ) -> void
+        {
+            unlink(watch);
+            task.swap(watch->task_);
+            onTimeout.swap(watch->onTimeout_);
+            watch->state_ = nullptr;
+            watch->next_ = free_;
+            free_ = watch;
+        }
+
+        /**
+         * Append a task to the list.  Called under the lock.
+         */
+        auto link( Watch* watch ) -> void
+        {
+            watch->prev_ = tail_;
+            watch->next_ = nullptr;
+            (tail_ ? tail_->next_ : head_) = watch;
+            tail_ = watch;
+            watch->armed_ = true;
+        }
+
+        /**
+         * Remove a task from the list.  Called under the lock.
+         */
+        auto unlink( Watch* watch ) -> void
+        {
+            if (!watch->armed_) {
+                return;
+            }
+
+            (watch->prev_ ? watch->prev_->next_ : head_) = watch->next_;
+            (watch->next_ ? watch->next_->prev_ : tail_) = watch->prev_;
+            watch->armed_ = false;
+        }
+
+        /**
+         * Arm the shared timer for the head of the list.  Called under
+         * the lock.
+         */
+        static auto arm( const std::shared_ptr<State>& self ) -> void
+        {
+            if (self->timerPending_ || self->head_ == nullptr || self->closed_) {
+                return;
+            }
+
+            auto delay = self->head_->deadline_ - self->scheduler_.now();
+
+            self->timerPending_ = self->scheduler_.scheduleIn(
+                [self]() { expire(self); },
+                std::max(
+                    Duration{},
+                    std::chrono::ceil<Duration>(delay) ) );
+        }
+
+        /**
+         * Cancel all tasks whose deadline passed and re-arm the timer.
+         */
+        static auto expire( const std::shared_ptr<State>& self ) -> void
+        {
+            std::vector<THUNK> callbacks;
+
+            {
+                std::lock_guard<std::mutex> lock(self->mutex_);
+
+                self->timerPending_ = false;
+
+                // The watchdog is destroyed, the callbacks may refer to
+                // objects that no longer exist.
+                if (self->closed_) {
+                    return;
+                }
+
+                auto now = self->scheduler_.now();
+
+                while (self->head_ && self->head_->deadline_ <= now) {
+                    auto watch = self->head_;
+                    self->unlink(watch);
+                    watch->cancelled_ = true;
+                    if (watch->onTimeout_) {
+                        callbacks.push_back(std::move(watch->onTimeout_));
+                    }
+                }
+
+                arm(self);
+            }
+
+            for (auto& callback : callbacks) {
+                callback();
+            }
+        }
+    };
+
+    ThreadPool& pool_;
+
+    std::shared_ptr<State> state_;
+
+    /**
+     * Execute a task and disarm it.  Does not access the watchdog, which
+     * may already be destroyed when the task finishes.
+     */
+    static auto run( Watch* watch ) -> void
+    {
+        struct Guard {
+            Watch* watch_;
+            ~Guard()
+            {
+                // Keeps the state alive until the watch is recycled.
+                auto state = watch_->state_;
+                TASK task;
+                THUNK onTimeout;
+
+                std::lock_guard<std::mutex> lock(state->mutex_);
+                state->recycle(watch_, task, onTimeout);
+            }
+        } guard{ watch };
+
+        if (!watch->isCancelled()) {
+            watch->task_(*watch);
+        }
+    }
+
+public:
+    /**
+     * Create an instance.
+     *
+     * @param pool The pool that executes the tasks.
+     * @param scheduler The scheduler that runs the shared timer.
+     * @param timeout The time a task may take from its submission until
+     * it finishes.
+     */
+    Watchdog( ThreadPool& pool, Scheduler& scheduler, Duration timeout )
+        : pool_{pool}
+        , state_{ std::make_shared<State>(scheduler, timeout) }
+    {
+    }
+
+    Watchdog(const Watchdog&) = delete;
+    Watchdog& operator=(const Watchdog&) = delete;
+
+    /**
+     * Stops the timeout handling.
+     */
+    ~Watchdog()
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex_);
+        state_->closed_ = true;
+    }
+
+    /**
+     * Execute a task on the thread pool.  If the task does not finish
+     * within the timeout, its cancellation state is set and the timeout
+     * callback is called.  A task that is cancelled before it started
+     * is not executed.
+     *
+     * @param task The task to execute.
+     * @param onTimeout Called on the scheduler when the timeout passed.
+     * May be empty.
+     * @throws std::runtime_error if the threadpool is already stopped.
+     */
+    auto exec( TASK task, THUNK onTimeout = {} ) -> void
+    {
+        Watch* watch;
+
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex_);
+            watch = state_->acquire();
+            watch->state_ = state_;
+            watch->task_ = std::move(task);
+            watch->onTimeout_ = std::move(onTimeout);
+            watch->deadline_ = state_->scheduler_.now() + state_->timeout_;
+            state_->link(watch);
+            State::arm(state_);
+        }
+
+        try {
+            // The thunk fits into the std::function without allocation.
+            pool_.exec( [watch]() { run(watch); } );
+        }
+        catch (...) {
+            TASK dropped;
+            THUNK droppedTimeout;
+
+            std::lock_guard<std::mutex> lock(state_->mutex_);
+            state_->recycle(watch, dropped, droppedTimeout);
+            throw;
+        }
+    }
+
+    /**
+     * Get the number of tasks that are pending or running and whose
+     * deadline did not pass.
+     */
+    auto armed() const -> size_t
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex_);
+
+        size_t result = 0;
+        for (auto c = state_->head_; c; c = c->next_) {
+            ++result;
+        }
+
+        return result;
+    }
+};
+
+} // namespace smack
@@ -0,0 +1,310 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Scheduler benchmarks.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <smack_cli.hpp>
+#include <smack_clock.h>
+#include <smack_scheduler.h>
+#include <smack_threadpool.h>
+#include <smack_util_allocations.hpp>
+#include <smack_util_time_probe.hpp>
+
+// Counts the allocations of the benchmarks.
+SMACK_ALLOCATION_HOOK;
+
+namespace {
+
+using smack::cli::Commands;
+using namespace std::chrono;
+using std::cout;
+
+using Clock = steady_clock;
+
+auto seconds( Clock::duration d ) -> double
+{
+    return duration<double>(d).count();
+}
+
+auto report( const char* name, double value, const char* unit ) -> void
+{
+    cout << std::left << std::setw(28) << name
+        << std::right << std::setw(16) << std::fixed << std::setprecision(1) << value
+        << ' ' << unit << '\n';
+}
+
+/**
+ * Wait until the scheduler fired the passed number of tasks.
+ */
+auto awaitFired( const smack::Scheduler& scheduler, uint64_t count ) -> void
+{
+    while (scheduler.statistics().fired < count) {
+        std::this_thread::yield();
+    }
+}
+
+/**
+ * Measures the insertion throughput of concurrent producers.  The
+ * timers are due in the far future and never fire.
+ */
+int insert( unsigned producers, unsigned timers )
+{
+    smack::Scheduler scheduler{ [](std::vector<smack::THUNK>&&){} };
+
+    std::atomic<bool> go = false;
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < producers; ++i) {
+        threads.emplace_back( [&scheduler, &go, timers]() {
+            while (!go) {
+                std::this_thread::yield();
+            }
+            for (unsigned j = 0; j < timers; ++j) {
+                scheduler.scheduleIn( [](){}, 1h );
+            }
+        });
+    }
+
+    auto start = Clock::now();
+    go = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto elapsed = Clock::now() - start;
+
+    report( "insert", producers * double(timers) / seconds(elapsed), "timers/s" );
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Measures the rate at which due timers are passed to the consumer
+ * if all timers are due at the same time.  Uses a virtual clock, so
+ * that the insertion time does not matter.
+ */
+int fire( unsigned timers )
+{
+    smack::VirtualClock clock;
+    smack::Scheduler scheduler{ clock, [](std::vector<smack::THUNK>&& batch) {
+        for (auto& thunk : batch) {
+            thunk();
+        }
+    } };
+
+    for (unsigned i = 0; i < timers; ++i) {
+        scheduler.scheduleIn( [](){}, 1s );
+    }
+    // Moves the inbox into the task map.
+    clock.advance(0ms);
+
+    auto start = Clock::now();
+    clock.advance(1s);
+    auto elapsed = Clock::now() - start;
+
+    report( "fire", timers / seconds(elapsed), "timers/s" );
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Measures the cost of replacing a pending timer.  The Scheduler has
+ * no cancel operation, a replace invalidates the pending timer with a
+ * generation token and schedules a new one.  The cost includes the
+ * dispatch of the stale timers, which are skipped when they fire.
+ */
+int cancel( unsigned timers )
+{
+    struct Token {
+        uint64_t generation = 0;
+        uint64_t fired = 0;
+    } token;
+
+    smack::VirtualClock clock;
+    smack::Scheduler scheduler{ clock, [](std::vector<smack::THUNK>&& batch) {
+        for (auto& thunk : batch) {
+            thunk();
+        }
+    } };
+
+    auto start = Clock::now();
+    for (unsigned i = 0; i < timers; ++i) {
+        scheduler.scheduleIn(
+            [&token, generation = ++token.generation]() {
+                if (generation == token.generation) {
+                    token.fired++;
+                }
+            },
+            1s );
+    }
+    clock.advance(1s);
+    auto elapsed = Clock::now() - start;
+
+    if (token.fired != 1) {
+        cout << "Stale timers were not skipped.\n";
+        return EXIT_FAILURE;
+    }
+
+    report( "cancel", 1e9 * seconds(elapsed) / timers, "ns/replace" );
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Measures the heap allocations of inserting a timer until it is pending
+ * in the task map.  The bytes are allocated, not retained: the inbox
+ * submission is freed when the inbox drains.  Uses a virtual clock to
+ * move the timers deterministically into the task map on the calling
+ * thread.
+ */
+int memory( unsigned timers )
+{
+    using smack::util::AllocationCounter;
+
+    smack::VirtualClock clock;
+    smack::Scheduler scheduler{ clock };
+
+    auto before = AllocationCounter::current();
+    for (unsigned i = 0; i < timers; ++i) {
+        scheduler.scheduleIn( [](){}, 1h );
+    }
+    // Moves the inbox into the task map.
+    clock.advance(0ms);
+    auto after = AllocationCounter::current();
+
+    report(
+        "memory",
+        double(after.allocations - before.allocations) / timers,
+        "allocs/insert" );
+    report(
+        "memory",
+        double(after.bytes - before.bytes) / timers,
+        "allocated bytes/insert" );
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Measures the lateness of timers spread randomly over a period while
+ * producers keep inserting and a thread pool executes the tasks.
+ */
+int lateness( unsigned producers, unsigned timers, unsigned periodMs )
+{
+    smack::ThreadPool pool;
+    smack::Scheduler scheduler{ [&pool](std::vector<smack::THUNK>&& batch) {
+        pool.exec( std::move(batch) );
+    } };
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < producers; ++i) {
+        threads.emplace_back( [&scheduler, timers, periodMs, i]() {
+            std::mt19937 random{ i };
+            std::uniform_int_distribution<unsigned> delay{ 0, periodMs };
+            for (unsigned j = 0; j < timers; ++j) {
+                scheduler.scheduleIn( [](){}, milliseconds{ delay(random) } );
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    awaitFired( scheduler, uint64_t{producers} * timers );
+
+    auto statistics = scheduler.statistics();
+    const std::pair<const char*, double> percentiles[] = {
+        { "lateness p50", 0.5 },
+        { "lateness p90", 0.9 },
+        { "lateness p99", 0.99 },
+        { "lateness p99.9", 0.999 } };
+    for (auto [name, fraction] : percentiles) {
+        report( name,
+            double(statistics.latenessHistogram.percentile(fraction)),
+            "us" );
+    }
+    report( "batches", double(statistics.batches), "" );
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Measures how the submission throughput of a shared thread pool scales
+ * with the number of submitting threads.
+ */
+int scaling( unsigned tasks )
+{
+    smack::ThreadPool pool;
+
+    auto results = smack::util::TimeProbe::profile_scaling(
+        tasks,
+        [&pool]() { pool.exec( [](){} ); } );
+
+    for (const auto& r : results) {
+        auto name = "exec " + std::to_string(r.threads) + " threads";
+        report( name.c_str(), r.throughput, "tasks/s" );
+        report( "  efficiency", 100.0 * r.efficiency, "%" );
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Runs all benchmarks with default sizes.
+ */
+int all()
+{
+    auto producers = std::max(1u, std::thread::hardware_concurrency());
+
+    insert( producers, 100'000 );
+    fire( 1'000'000 );
+    cancel( 1'000'000 );
+    memory( 100'000 );
+    lateness( producers, 100'000, 1'000 );
+    scaling( 100'000 );
+
+    return EXIT_SUCCESS;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    smack::cli::CliApplication cli{
+        "Scheduler benchmarks.",
+
+        Commands::make<all>(
+            "all", "Run all benchmarks with default sizes."),
+        Commands::make<insert>(
+            "insert", "Insertion throughput of concurrent producers.",
+            { "producers", "timers" }),
+        Commands::make<fire>(
+            "fire", "Fire rate of timers that are due at the same time.",
+            { "timers" }),
+        Commands::make<cancel>(
+            "cancel", "Cost of replacing a pending timer with a generation token.",
+            { "timers" }),
+        Commands::make<memory>(
+            "memory", "Heap allocations per inserted timer.",
+            { "timers" }),
+        Commands::make<lateness>(
+            "lateness", "Lateness percentiles under load.",
+            { "producers", "timers", "periodMs" }),
+        Commands::make<scaling>(
+            "scaling", "Thread pool submission throughput by submitting threads.",
+            { "tasks" })
+    };
+
+    return cli.launch(argc, argv);
+}
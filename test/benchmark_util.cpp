@@ -0,0 +1,73 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Micro benchmarks of the util library.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#include <string>
+#include <string_view>
+
+#include <smack_convert.hpp>
+#include <smack_properties.hpp>
+#include <smack_util.hpp>
+#include <smack_util_allocations.hpp>
+#include <smack_util_benchmark.hpp>
+#include <smack_util_profiler.hpp>
+
+using smack::util::do_not_optimize;
+
+SMACK_ALLOCATION_HOOK;
+
+SMACK_BENCHMARK(split) {
+    do_not_optimize( smack::split( "alpha,beta,gamma,delta", "," ) );
+}
+
+SMACK_BENCHMARK(trim) {
+    do_not_optimize( smack::trim( std::string{ "   alpha beta   " } ) );
+}
+
+SMACK_BENCHMARK(transform_int) {
+    int result;
+    smack::convert::transform( "31415", result );
+    do_not_optimize( result );
+}
+
+SMACK_BENCHMARK(properties_get) {
+    static const smack::util::properties::Properties properties{ "benchmark.properties" };
+    static const std::string key{ "benchmark.property.not.in.the.file" };
+    do_not_optimize( properties.get( key, "a default that exceeds the small string buffer" ) );
+}
+
+SMACK_BENCHMARK_RANGE(split_n, 64, 64 * 1024) {
+    static std::string input;
+    if (input.size() != n) {
+        input.clear();
+        while (input.size() < n) {
+            input += "token,";
+        }
+        input.resize(n);
+    }
+    do_not_optimize( smack::split( input, "," ) );
+}
+
+SMACK_BENCHMARK_RANGE(trim_n, 64, 64 * 1024) {
+    static std::string input;
+    if (input.size() != n) {
+        input = std::string( n / 2, ' ' ) + "x" + std::string( n - n / 2 - 1, ' ' );
+    }
+    do_not_optimize( smack::trim( std::string_view{ input } ) );
+}
+
+SMACK_BENCHMARK(thread_id) {
+    do_not_optimize( smack::thread_id() );
+}
+
+SMACK_BENCHMARK(zone) {
+    SMACK_ZONE("benchmark");
+}
+
+int main(int argc, char** argv)
+{
+    return smack::util::Benchmark::main(argc, argv);
+}
@@ -0,0 +1,73 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Tests.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <smack_util.hpp>
+#include <smack_util_allocations.hpp>
+#include <smack_util_benchmark.hpp>
+#include <smack_util_time_probe.hpp>
+
+// Counts the allocations of the test program.
+SMACK_ALLOCATION_HOOK;
+
+using smack::util::AllocationCounter;
+
+TEST(AllocationCounter, installed) {
+    EXPECT_TRUE(AllocationCounter::installed());
+}
+
+TEST(AllocationCounter, counts) {
+    auto before = AllocationCounter::current();
+
+    auto p = std::make_unique<int[]>(100);
+    auto q = std::make_unique<double>(1.0);
+
+    auto after = AllocationCounter::current();
+    EXPECT_EQ(2u, after.allocations - before.allocations);
+    EXPECT_EQ(100 * sizeof(int) + sizeof(double), after.bytes - before.bytes);
+}
+
+TEST(AllocationCounter, per_thread) {
+    auto before = AllocationCounter::current();
+
+    std::thread{ []() {
+        std::vector<int> v(1000);
+        smack::util::do_not_optimize(v);
+    } }.join();
+
+    // Only the allocations of std::thread itself are counted.
+    auto after = AllocationCounter::current();
+    EXPECT_GT(1000 * sizeof(int), after.bytes - before.bytes);
+}
+
+TEST(AllocationCounter, profile_statistics) {
+    std::vector<double> samples;
+    samples.reserve(10);
+
+    auto result = smack::util::TimeProbe::profile_statistics(
+        10,
+        []() {
+            smack::util::do_not_optimize(
+                smack::split("alpha,beta,gamma", ","));
+        },
+        samples);
+
+    // The vector and the three strings, which fit the small buffer.
+    EXPECT_GE(result.allocations, 1.0);
+    EXPECT_GE(result.allocatedBytes, 3 * sizeof(std::string));
+
+    auto none = smack::util::TimeProbe::profile_statistics(
+        10, []() {}, samples);
+    EXPECT_EQ(0.0, none.allocations);
+    EXPECT_EQ(0.0, none.allocatedBytes);
+}
@@ -0,0 +1,185 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Tests.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include <smack_util_benchmark.hpp>
+
+using smack::util::Benchmark;
+
+namespace {
+
+int counter = 0;
+
+} // namespace
+
+SMACK_BENCHMARK(test_increment) {
+    counter++;
+    smack::util::clobber_memory();
+}
+
+namespace {
+
+auto quick() -> Benchmark::Options
+{
+    Benchmark::Options result;
+    result.budget = std::chrono::milliseconds{ 10 };
+    result.warmup = std::chrono::milliseconds{ 1 };
+    result.samples = 5;
+    return result;
+}
+
+} // namespace
+
+TEST(Benchmark, registered) {
+    auto names = Benchmark::names();
+
+    EXPECT_NE(names.end(), std::find(names.begin(), names.end(), "test_increment"));
+}
+
+TEST(Benchmark, run_calibrates) {
+    counter = 0;
+
+    auto results = Benchmark::run( "^test_inc", quick() );
+
+    ASSERT_EQ(1u, results.size());
+    EXPECT_EQ("test_increment", results[0].name);
+    EXPECT_EQ(5u, results[0].statistics.samples);
+    // Calibrated beyond a single iteration per sample.
+    EXPECT_GT(results[0].iterations, 1u);
+    EXPECT_GE(counter, static_cast<int>(5 * results[0].iterations));
+    EXPECT_GT(results[0].statistics.median, 0.0);
+}
+
+TEST(Benchmark, filter) {
+    EXPECT_TRUE(Benchmark::run( "^no_such_benchmark$", quick() ).empty());
+}
+
+TEST(Benchmark, format) {
+    EXPECT_EQ(Benchmark::Format::Text, Benchmark::format("text"));
+    EXPECT_EQ(Benchmark::Format::Csv, Benchmark::format("csv"));
+    EXPECT_EQ(Benchmark::Format::Json, Benchmark::format("json"));
+    EXPECT_THROW(Benchmark::format("xml"), std::invalid_argument);
+}
+
+TEST(Benchmark, print) {
+    smack::util::BenchmarkResult result;
+    result.name = "a\"b";
+    result.iterations = 10;
+    result.statistics.samples = 3;
+
+    std::ostringstream csv;
+    Benchmark::print( csv, { result }, Benchmark::Format::Csv );
+    EXPECT_EQ(0u, csv.str().find("name,iterations,samples,"));
+    EXPECT_NE(std::string::npos, csv.str().find("\n\"a\"\"b\",10,3,"));
+
+    std::ostringstream json;
+    Benchmark::print( json, { result }, Benchmark::Format::Json );
+    EXPECT_NE(std::string::npos, json.str().find("\"name\": \"a\\\"b\""));
+    EXPECT_NE(std::string::npos, json.str().find("\"iterations\": 10"));
+
+    // The stream format of the caller is kept.
+    std::ostringstream text;
+    text << std::scientific << std::setprecision(2);
+    Benchmark::print( text, { result }, Benchmark::Format::Text );
+    EXPECT_EQ(std::ios_base::scientific, text.flags() & std::ios_base::floatfield);
+    EXPECT_EQ(2, text.precision());
+}
+
+namespace {
+
+size_t lastSize = 0;
+
+} // namespace
+
+SMACK_BENCHMARK_RANGE(test_range, 4, 20) {
+    lastSize = n;
+    smack::util::clobber_memory();
+}
+
+TEST(Benchmark, range) {
+    auto results = Benchmark::run( "^test_range$", quick() );
+
+    // 4, 8, 16.
+    ASSERT_EQ(3u, results.size());
+    EXPECT_EQ("test_range/4", results[0].name);
+    EXPECT_EQ(4u, results[0].size);
+    EXPECT_EQ("test_range/16", results[2].name);
+    EXPECT_EQ(16u, results[2].size);
+    EXPECT_EQ(16u, lastSize);
+
+    auto fits = Benchmark::fit( results );
+    ASSERT_EQ(1u, fits.size());
+    EXPECT_EQ("test_range", fits[0].name);
+}
+
+TEST(Benchmark, range_invalid) {
+    auto loop = [](size_t, size_t) {};
+
+    EXPECT_THROW(Benchmark::add( "invalid", +loop, 0, 10 ), std::invalid_argument);
+    EXPECT_THROW(Benchmark::add( "invalid", +loop, 10, 5 ), std::invalid_argument);
+}
+
+TEST(Benchmark, fit) {
+    using smack::util::Complexity;
+
+    std::vector<size_t> sizes{ 16, 64, 256, 1024, 4096 };
+
+    auto fitted = [&sizes](auto f) {
+        std::vector<double> times;
+        for (auto n : sizes) {
+            times.push_back(f(double(n)));
+        }
+        return Benchmark::fit( sizes, times );
+    };
+
+    auto constant = fitted([](double) { return 5e-9; });
+    EXPECT_EQ(Complexity::O1, constant.complexity);
+    EXPECT_NEAR(5e-9, constant.coefficient, 1e-15);
+    EXPECT_NEAR(0.0, constant.rms, 1e-9);
+
+    EXPECT_EQ(Complexity::OLogN, fitted([](double n) { return 1e-9 * std::log2(n); }).complexity);
+
+    auto linear = fitted([](double n) { return 2e-9 * n * 1.01; });
+    EXPECT_EQ(Complexity::ON, linear.complexity);
+    EXPECT_NEAR(2.02e-9, linear.coefficient, 1e-15);
+
+    EXPECT_EQ(Complexity::ONLogN, fitted([](double n) { return 1e-9 * n * std::log2(n); }).complexity);
+    EXPECT_EQ(Complexity::ON2, fitted([](double n) { return 1e-9 * n * n + 1e-6; }).complexity);
+}
+
+TEST(Benchmark, complexity_names) {
+    using smack::util::Complexity;
+
+    EXPECT_STREQ("O(1)", Benchmark::name(Complexity::O1));
+    EXPECT_STREQ("O(n log n)", Benchmark::name(Complexity::ONLogN));
+    EXPECT_STREQ("O(n^2)", Benchmark::name(Complexity::ON2));
+}
+
+TEST(Benchmark, print_complexity) {
+    smack::util::ComplexityResult complexity;
+    complexity.name = "n";
+    complexity.complexity = smack::util::Complexity::ON;
+    complexity.coefficient = 1e-9;
+
+    std::ostringstream json;
+    Benchmark::print( json, {}, { complexity }, Benchmark::Format::Json );
+    EXPECT_NE(std::string::npos, json.str().find("\"complexity\": ["));
+    EXPECT_NE(std::string::npos, json.str().find("\"complexity\": \"O(n)\""));
+    EXPECT_EQ(json.str().size() - 3, json.str().rfind("\n}\n"));
+
+    std::ostringstream text;
+    Benchmark::print( text, {}, { complexity }, Benchmark::Format::Text );
+    EXPECT_NE(std::string::npos, text.str().find("O(n)"));
+}
@@ -0,0 +1,97 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Tests.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#include <gtest/gtest.h>
+
+#include <optional>
+#include <vector>
+
+#include <smack_clock.h>
+
+namespace {
+
+/**
+ * Requests steps at fixed times.
+ */
+class Steps : public smack::VirtualClock::Listener
+{
+    std::vector<smack::TimePoint> times_;
+    size_t position_ = 0;
+
+public:
+    Steps(std::vector<smack::TimePoint> times) : times_(times) {}
+
+    auto next() -> std::optional<smack::TimePoint> override
+    {
+        if (position_ == times_.size()) {
+            return {};
+        }
+
+        return times_[position_];
+    }
+
+    auto step() -> void override
+    {
+        position_++;
+    }
+};
+
+} // namespace
+
+TEST(Clock, system) {
+    auto before = std::chrono::system_clock::now();
+    auto now = smack::SystemClock::instance().now();
+
+    EXPECT_LE(before, now);
+    EXPECT_LE(now, std::chrono::system_clock::now());
+}
+
+TEST(Clock, virtual_advance) {
+    smack::VirtualClock clock{ smack::TimePoint{} + 1h };
+
+    EXPECT_EQ(smack::TimePoint{} + 1h, clock.now());
+
+    clock.advance(30min);
+
+    EXPECT_EQ(smack::TimePoint{} + 90min, clock.now());
+
+    // Does not move backwards.
+    clock.advanceTo(smack::TimePoint{});
+
+    EXPECT_EQ(smack::TimePoint{} + 90min, clock.now());
+}
+
+TEST(Clock, virtual_listeners_in_time_order) {
+    smack::VirtualClock clock;
+    auto t0 = clock.now();
+
+    std::vector<int> order;
+
+    struct Recorder : Steps {
+        std::vector<int>& order_;
+        int id_;
+        Recorder(std::vector<smack::TimePoint> times, std::vector<int>& order, int id)
+            : Steps(times), order_(order), id_(id) {}
+        auto step() -> void override { order_.push_back(id_); Steps::step(); }
+    };
+
+    Recorder a{ { t0 + 1s, t0 + 4s }, order, 1 };
+    Recorder b{ { t0 + 2s, t0 + 3s, t0 + 10s }, order, 2 };
+
+    clock.attach(a);
+    clock.attach(b);
+
+    clock.advance(5s);
+
+    EXPECT_EQ((std::vector<int>{ 1, 2, 2, 1 }), order);
+    EXPECT_EQ(t0 + 5s, clock.now());
+
+    clock.detach(b);
+    clock.advance(10s);
+
+    EXPECT_EQ(4u, order.size());
+}
@@ -0,0 +1,137 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Tests.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <stdexcept>
+
+#include <smack_cron.h>
+
+namespace {
+
+using namespace std::chrono;
+
+/**
+ * Create a UTC time point.
+ */
+auto utc(int y, unsigned m, unsigned d, int hh = 0, int mm = 0, int ss = 0) -> smack::TimePoint
+{
+    // Days since the epoch, see smack_cron.cpp.
+    int yy = y - (m <= 2);
+    int era = (yy >= 0 ? yy : yy - 399) / 400;
+    unsigned yoe = static_cast<unsigned>(yy - era * 400);
+    unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    long days = era * 146097L + static_cast<long>(doe) - 719468;
+
+    return smack::TimePoint{ duration_cast<smack::TimePoint::duration>(
+        hours{days * 24 + hh} + minutes{mm} + seconds{ss}) };
+}
+
+} // namespace
+
+TEST(CronTest, daily)
+{
+    smack::CronExpression cron{ "0 2 * * *" };
+
+    EXPECT_EQ(utc(2026, 3, 14, 2, 0), cron.next(utc(2026, 3, 14, 1, 30)));
+    EXPECT_EQ(utc(2026, 3, 15, 2, 0), cron.next(utc(2026, 3, 14, 2, 0)));
+    // Year end.
+    EXPECT_EQ(utc(2027, 1, 1, 2, 0), cron.next(utc(2026, 12, 31, 3, 0)));
+}
+
+TEST(CronTest, step)
+{
+    smack::CronExpression cron{ "*/15 * * * *" };
+
+    EXPECT_EQ(utc(2026, 3, 14, 10, 15), cron.next(utc(2026, 3, 14, 10, 0)));
+    EXPECT_EQ(utc(2026, 3, 14, 10, 15), cron.next(utc(2026, 3, 14, 10, 7, 59)));
+    EXPECT_EQ(utc(2026, 3, 14, 11, 0), cron.next(utc(2026, 3, 14, 10, 45)));
+
+    smack::CronExpression offset{ "5/20 8-10 * * *" };
+    EXPECT_EQ(utc(2026, 3, 14, 8, 5), offset.next(utc(2026, 3, 14, 0, 0)));
+    EXPECT_EQ(utc(2026, 3, 14, 10, 45), offset.next(utc(2026, 3, 14, 10, 25)));
+    EXPECT_EQ(utc(2026, 3, 15, 8, 5), offset.next(utc(2026, 3, 14, 10, 45)));
+}
+
+TEST(CronTest, listsAndRanges)
+{
+    smack::CronExpression cron{ "0,30 9-17/4 1,15 * *" };
+
+    EXPECT_EQ(utc(2026, 3, 15, 9, 0), cron.next(utc(2026, 3, 2, 0, 0)));
+    EXPECT_EQ(utc(2026, 3, 15, 13, 30), cron.next(utc(2026, 3, 15, 13, 0)));
+    EXPECT_EQ(utc(2026, 4, 1, 9, 0), cron.next(utc(2026, 3, 15, 17, 30)));
+}
+
+TEST(CronTest, dayOfWeek)
+{
+    // 2026-03-14 is a Saturday.
+    smack::CronExpression monday{ "0 8 * * 1" };
+    EXPECT_EQ(utc(2026, 3, 16, 8, 0), monday.next(utc(2026, 3, 14, 0, 0)));
+
+    // Both 0 and 7 are Sunday.
+    smack::CronExpression sunday{ "0 8 * * 7" };
+    EXPECT_EQ(utc(2026, 3, 15, 8, 0), sunday.next(utc(2026, 3, 14, 0, 0)));
+    smack::CronExpression sunday0{ "0 8 * * 0" };
+    EXPECT_EQ(utc(2026, 3, 15, 8, 0), sunday0.next(utc(2026, 3, 14, 0, 0)));
+
+    // Weekdays across a month end.
+    smack::CronExpression weekdays{ "0 0 * * 1-5" };
+    EXPECT_EQ(utc(2026, 6, 1, 0, 0), weekdays.next(utc(2026, 5, 29, 0, 0)));
+}
+
+TEST(CronTest, dayOfMonthOrDayOfWeek)
+{
+    // The 20th or any Monday.
+    smack::CronExpression cron{ "0 0 20 * 1" };
+
+    EXPECT_EQ(utc(2026, 3, 16, 0, 0), cron.next(utc(2026, 3, 14, 0, 0)));
+    EXPECT_EQ(utc(2026, 3, 20, 0, 0), cron.next(utc(2026, 3, 16, 0, 0)));
+}
+
+TEST(CronTest, dayOfMonthStepAndDayOfWeek)
+{
+    // A field starting with '*' is unrestricted, so a day has to match
+    // both: Mondays that are an odd day of the month.
+    smack::CronExpression cron{ "0 0 */2 * 1" };
+
+    EXPECT_EQ(utc(2026, 3, 23, 0, 0), cron.next(utc(2026, 3, 14, 0, 0)));
+    EXPECT_EQ(utc(2026, 4, 13, 0, 0), cron.next(utc(2026, 3, 23, 0, 0)));
+}
+
+TEST(CronTest, leapDay)
+{
+    smack::CronExpression cron{ "0 0 29 2 *" };
+
+    EXPECT_EQ(utc(2028, 2, 29, 0, 0), cron.next(utc(2026, 3, 14, 0, 0)));
+    // 2100 is not a leap year.
+    EXPECT_EQ(utc(2104, 2, 29, 0, 0), cron.next(utc(2096, 3, 1, 0, 0)));
+}
+
+TEST(CronTest, never)
+{
+    smack::CronExpression cron{ "0 0 30 2 *" };
+
+    EXPECT_FALSE(cron.next(utc(2026, 3, 14, 0, 0)));
+}
+
+TEST(CronTest, invalid)
+{
+    EXPECT_THROW(smack::CronExpression{ "" }, std::invalid_argument);
+    EXPECT_THROW(smack::CronExpression{ "* * * *" }, std::invalid_argument);
+    EXPECT_THROW(smack::CronExpression{ "* * * * * *" }, std::invalid_argument);
+    EXPECT_THROW(smack::CronExpression{ "60 * * * *" }, std::invalid_argument);
+    EXPECT_THROW(smack::CronExpression{ "* 24 * * *" }, std::invalid_argument);
+    EXPECT_THROW(smack::CronExpression{ "* * 0 * *" }, std::invalid_argument);
+    EXPECT_THROW(smack::CronExpression{ "* * * 13 *" }, std::invalid_argument);
+    EXPECT_THROW(smack::CronExpression{ "* * * * 8" }, std::invalid_argument);
+    EXPECT_THROW(smack::CronExpression{ "*/0 * * * *" }, std::invalid_argument);
+    EXPECT_THROW(smack::CronExpression{ "10-5 * * * *" }, std::invalid_argument);
+    EXPECT_THROW(smack::CronExpression{ "a * * * *" }, std::invalid_argument);
+    EXPECT_THROW(smack::CronExpression{ "1,,2 * * * *" }, std::invalid_argument);
+}
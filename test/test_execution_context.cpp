@@ -0,0 +1,93 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Tests.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#include <gtest/gtest.h>
+
+#include <future>
+
+#include <smack_clock.h>
+#include <smack_execution_context.h>
+#include <smack_scheduler.h>
+#include <smack_threadpool.h>
+
+using smack::ExecutionContext;
+
+TEST(ExecutionContext, scope_restores) {
+    EXPECT_EQ(0u, ExecutionContext::current().traceId);
+    EXPECT_EQ(smack::TimePoint::max(), ExecutionContext::current().deadline);
+
+    {
+        ExecutionContext::Scope outer{ { 1, smack::TimePoint{} + 1s } };
+        EXPECT_EQ(1u, ExecutionContext::current().traceId);
+
+        {
+            ExecutionContext::Scope inner{ { 2 } };
+            EXPECT_EQ(2u, ExecutionContext::current().traceId);
+        }
+
+        EXPECT_EQ(1u, ExecutionContext::current().traceId);
+        EXPECT_EQ(smack::TimePoint{} + 1s, ExecutionContext::current().deadline);
+    }
+
+    EXPECT_EQ(0u, ExecutionContext::current().traceId);
+}
+
+TEST(ExecutionContext, threadpool) {
+    smack::ThreadPool pool{ 2 };
+
+    std::promise<ExecutionContext> result;
+    {
+        ExecutionContext::Scope scope{ { 42, smack::TimePoint{} + 5s } };
+        pool.exec( [&result](){ result.set_value( ExecutionContext::current() ); } );
+    }
+
+    auto context = result.get_future().get();
+    EXPECT_EQ(42u, context.traceId);
+    EXPECT_EQ(smack::TimePoint{} + 5s, context.deadline);
+}
+
+TEST(ExecutionContext, scheduler) {
+    smack::VirtualClock clock;
+    smack::Scheduler scheduler{ clock };
+
+    uint64_t single = 0;
+    std::vector<uint64_t> cyclic;
+    {
+        ExecutionContext::Scope scope{ { 7 } };
+        scheduler.scheduleIn( [&single](){ single = ExecutionContext::current().traceId; }, 1s );
+    }
+    {
+        ExecutionContext::Scope scope{ { 8 } };
+        scheduler.scheduleCyclic( [&cyclic](){ cyclic.push_back( ExecutionContext::current().traceId ); }, 1s );
+    }
+
+    clock.advance(2s);
+
+    EXPECT_EQ(7u, single);
+    EXPECT_EQ((std::vector<uint64_t>{ 8, 8, 8 }), cyclic);
+    EXPECT_EQ(0u, ExecutionContext::current().traceId);
+}
+
+// The context travels across a scheduler and a thread pool hop.
+TEST(ExecutionContext, scheduler_to_pool) {
+    smack::ThreadPool pool{ 2 };
+    smack::Scheduler scheduler{ [&pool](std::vector<smack::THUNK>&& batch) {
+        pool.exec( std::move(batch) );
+    } };
+
+    std::promise<uint64_t> result;
+    {
+        ExecutionContext::Scope scope{ { 99 } };
+        scheduler.scheduleIn( [&result, &pool](){
+            pool.exec( [&result](){ result.set_value( ExecutionContext::current().traceId ); } );
+        }, 10ms );
+    }
+
+    auto future = result.get_future();
+    ASSERT_EQ(std::future_status::ready, future.wait_for(2s));
+    EXPECT_EQ(99u, future.get());
+}
@@ -0,0 +1,121 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Tests.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include <smack_util_histogram.hpp>
+
+using smack::util::Histogram;
+
+TEST(Histogram, buckets) {
+    // Small values are exact.
+    for (uint64_t v = 0; v < Histogram::SUB_BUCKETS; ++v) {
+        EXPECT_EQ(v, Histogram::index(v));
+        EXPECT_EQ(v, Histogram::lowest(v));
+        EXPECT_EQ(v, Histogram::highest(v));
+    }
+
+    // Buckets are contiguous and cover the value range.
+    for (size_t i = 1; i < Histogram::BUCKETS; ++i) {
+        EXPECT_EQ(Histogram::highest(i - 1) + 1, Histogram::lowest(i)) << i;
+        EXPECT_EQ(i, Histogram::index(Histogram::lowest(i))) << i;
+        EXPECT_EQ(i, Histogram::index(Histogram::highest(i))) << i;
+    }
+    EXPECT_EQ(
+        Histogram::BUCKETS - 1,
+        Histogram::index(std::numeric_limits<uint64_t>::max()));
+    EXPECT_EQ(
+        std::numeric_limits<uint64_t>::max(),
+        Histogram::highest(Histogram::BUCKETS - 1));
+}
+
+TEST(Histogram, precision) {
+    for (uint64_t v = 1; v < (uint64_t{1} << 40); v = v * 3 + 1) {
+        auto i = Histogram::index(v);
+        auto width = Histogram::highest(i) - Histogram::lowest(i);
+        EXPECT_LE(width * 32, v) << v;
+    }
+}
+
+TEST(Histogram, percentiles) {
+    Histogram histogram;
+    for (uint64_t v = 1; v <= 1000; ++v) {
+        histogram.record(v);
+    }
+
+    auto snapshot = histogram.snapshot();
+    EXPECT_EQ(1000u, snapshot.count());
+    EXPECT_EQ(500500u, snapshot.sum());
+    EXPECT_DOUBLE_EQ(500.5, snapshot.mean());
+    EXPECT_EQ(1u, snapshot.min());
+    EXPECT_EQ(Histogram::highest(Histogram::index(1000)), snapshot.max());
+
+    EXPECT_EQ(Histogram::highest(Histogram::index(500)), snapshot.percentile(0.5));
+    EXPECT_EQ(Histogram::highest(Histogram::index(990)), snapshot.percentile(0.99));
+    EXPECT_EQ(1u, snapshot.percentile(0.0));
+    EXPECT_EQ(snapshot.max(), snapshot.percentile(1.0));
+}
+
+TEST(Histogram, empty) {
+    Histogram::Snapshot snapshot;
+
+    EXPECT_EQ(0u, snapshot.count());
+    EXPECT_EQ(0.0, snapshot.mean());
+    EXPECT_EQ(0u, snapshot.min());
+    EXPECT_EQ(0u, snapshot.max());
+    EXPECT_EQ(0u, snapshot.percentile(0.99));
+}
+
+TEST(Histogram, interval_and_merge) {
+    Histogram histogram;
+    histogram.record(10);
+
+    auto first = histogram.snapshot();
+    histogram.record(20);
+    histogram.record(30);
+    auto interval = histogram.snapshot().since(first);
+
+    EXPECT_EQ(2u, interval.count());
+    EXPECT_EQ(50u, interval.sum());
+    EXPECT_EQ(20u, interval.min());
+    EXPECT_EQ(0u, interval.count(Histogram::index(10)));
+
+    interval.merge(first);
+    EXPECT_EQ(3u, interval.count());
+    EXPECT_EQ(10u, interval.min());
+
+    Histogram other;
+    other.merge(interval);
+    other.record(40);
+    EXPECT_EQ(4u, other.snapshot().count());
+    EXPECT_EQ(100u, other.snapshot().sum());
+}
+
+TEST(Histogram, concurrent) {
+    Histogram histogram;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&histogram]() {
+            for (uint64_t v = 0; v < 10000; ++v) {
+                histogram.record(v);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto snapshot = histogram.snapshot();
+    EXPECT_EQ(40000u, snapshot.count());
+    EXPECT_EQ(4u * (9999u * 10000u / 2), snapshot.sum());
+}
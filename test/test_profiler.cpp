@@ -0,0 +1,233 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Tests.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#include <gtest/gtest.h>
+
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <smack_util.hpp>
+#include <smack_util_chrome_trace.hpp>
+#include <smack_util_profiler.hpp>
+#include <smack_util_time_probe.hpp>
+
+using smack::util::ZoneProfiler;
+
+TEST(ChromeTrace, add) {
+    std::ostringstream out;
+
+    {
+        smack::util::ChromeTrace trace{ out };
+        trace.add(7, "a\"b", 1.0, 0.5);
+        trace.add(8, "c", 2.0, 0.25);
+    }
+
+    EXPECT_EQ(
+        "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n"
+        "{\"name\":\"a\\\"b\",\"ph\":\"X\",\"pid\":1,\"tid\":7,\"ts\":1000000.000,\"dur\":500000.000},\n"
+        "{\"name\":\"c\",\"ph\":\"X\",\"pid\":1,\"tid\":8,\"ts\":2000000.000,\"dur\":250000.000}\n"
+        "]}\n",
+        out.str());
+}
+
+TEST(ChromeTrace, stream_state) {
+    std::ostringstream out;
+    out << std::scientific << std::setprecision(2);
+
+    smack::util::ChromeTrace trace{ out };
+    trace.add(1, "a", 1.0, 0.5);
+
+    EXPECT_EQ(std::ios_base::scientific, out.flags() & std::ios_base::floatfield);
+    EXPECT_EQ(2, out.precision());
+}
+
+TEST(ChromeTrace, empty) {
+    std::ostringstream out;
+
+    smack::util::ChromeTrace trace{ out };
+    trace.close();
+    trace.add(1, "ignored", 0.0, 0.0);
+
+    EXPECT_EQ("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n]}\n", out.str());
+}
+
+#if !defined(SMACK_ZONES_DISABLED)
+
+namespace {
+
+void leaf()
+{
+    SMACK_ZONE("leaf");
+    smack::util::TimeProbe::sleepMs(1);
+}
+
+void outer()
+{
+    SMACK_ZONE("outer");
+    leaf();
+    leaf();
+}
+
+} // namespace
+
+TEST(ZoneProfiler, call_tree) {
+    ZoneProfiler::reset();
+
+    outer();
+    outer();
+
+    auto root = ZoneProfiler::collect();
+
+    auto o = root.find("outer");
+    ASSERT_NE(nullptr, o);
+    EXPECT_EQ(2u, o->calls);
+    auto l = o->find("leaf");
+    ASSERT_NE(nullptr, l);
+    EXPECT_EQ(4u, l->calls);
+    EXPECT_EQ(nullptr, root.find("leaf"));
+
+    EXPECT_GE(l->inclusive, 0.004);
+    EXPECT_GE(o->inclusive, l->inclusive);
+    EXPECT_NEAR(o->inclusive - l->inclusive, o->exclusive(), 1e-9);
+    EXPECT_LT(o->exclusive(), l->inclusive);
+}
+
+TEST(ZoneProfiler, open_zone_completes_later) {
+    ZoneProfiler::reset();
+
+    {
+        SMACK_ZONE("open");
+        leaf();
+
+        // The leaf is waiting for its parent.
+        EXPECT_EQ(nullptr, ZoneProfiler::collect().find("open"));
+    }
+
+    auto root = ZoneProfiler::collect();
+    auto open = root.find("open");
+    ASSERT_NE(nullptr, open);
+    EXPECT_EQ(1u, open->calls);
+    ASSERT_NE(nullptr, open->find("leaf"));
+    EXPECT_EQ(1u, open->find("leaf")->calls);
+}
+
+TEST(ZoneProfiler, threads) {
+    ZoneProfiler::reset();
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++) {
+        threads.emplace_back([]() {
+            for (int j = 0; j < 1000; j++) {
+                SMACK_ZONE("work");
+                SMACK_ZONE("inner");
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    auto root = ZoneProfiler::collect();
+    auto work = root.find("work");
+    ASSERT_NE(nullptr, work);
+    EXPECT_EQ(4000u, work->calls);
+    ASSERT_NE(nullptr, work->find("inner"));
+    EXPECT_EQ(4000u, work->find("inner")->calls);
+    EXPECT_EQ(0u, ZoneProfiler::dropped());
+}
+
+TEST(ZoneProfiler, dropped_parent) {
+    ZoneProfiler::reset();
+
+    {
+        SMACK_ZONE("dropped");
+        for (size_t i = 0; i < smack::util::ZoneBuffer::CAPACITY; i++) {
+            SMACK_ZONE("orphan");
+        }
+    }
+    EXPECT_EQ(1u, ZoneProfiler::dropped());
+    ZoneProfiler::collect();
+
+    {
+        SMACK_ZONE("next");
+        SMACK_ZONE("child");
+    }
+
+    auto root = ZoneProfiler::collect();
+    EXPECT_EQ(nullptr, root.find("dropped"));
+    auto next = root.find("next");
+    ASSERT_NE(nullptr, next);
+    ASSERT_EQ(1u, next->children.size());
+    EXPECT_STREQ("child", next->children[0].name);
+
+    ZoneProfiler::reset();
+}
+
+TEST(ZoneProfiler, report) {
+    ZoneProfiler::reset();
+
+    outer();
+
+    std::ostringstream out;
+    ZoneProfiler::report(out);
+
+    EXPECT_NE(std::string::npos, out.str().find("outer"));
+    EXPECT_NE(std::string::npos, out.str().find("  leaf"));
+}
+
+TEST(ChromeTrace, collect) {
+    ZoneProfiler::reset();
+
+    outer();
+
+    std::ostringstream out;
+    {
+        smack::util::ChromeTrace trace{ out };
+        trace.collect();
+    }
+
+    auto tid = "\"tid\":" + std::to_string(smack::thread_id());
+    auto json = out.str();
+    EXPECT_NE(std::string::npos, json.find("{\"name\":\"outer\",\"ph\":\"X\",\"pid\":1," + tid));
+    EXPECT_NE(std::string::npos, json.find("{\"name\":\"leaf\",\"ph\":\"X\",\"pid\":1," + tid));
+
+    // The call tree is still built.
+    EXPECT_NE(nullptr, ZoneProfiler::collect().find("outer"));
+}
+
+TEST(ZoneProfiler, overhead) {
+    ZoneProfiler::reset();
+
+    constexpr int count = 1000;
+
+    auto seconds = smack::util::TimeProbe::profile(10, []() {
+        for (int i = 0; i < count; i++) {
+            SMACK_ZONE("overhead");
+        }
+        ZoneProfiler::collect();
+    });
+
+    // Generous to stay stable on loaded machines.
+    EXPECT_LT(seconds / count, 1e-6);
+}
+
+TEST(ZoneProfiler, report_stream_state) {
+    ZoneProfiler::reset();
+
+    outer();
+
+    std::ostringstream out;
+    out << std::scientific << std::setprecision(2);
+    ZoneProfiler::report(out);
+
+    EXPECT_NE(std::string::npos, out.str().find("leaf"));
+    EXPECT_EQ(std::ios_base::scientific, out.flags() & std::ios_base::floatfield);
+    EXPECT_EQ(2, out.precision());
+}
+
+#endif
@@ -11,11 +11,15 @@
 #include <atomic>
 #include <future>
 #include <iostream>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #include <smack_scheduler.h>
 #include <smack_threadpool.h>
+#include <smack_util_allocations.hpp>
 
 auto consumer( smack::THUNK t ) -> void
 {
@@ -292,3 +296,589 @@ TEST(Scheduler, get_scheduler_returns_self_from_thunk) {
 TEST(Scheduler, get_scheduler_throws_outside_thunk) {
     EXPECT_THROW(smack::Scheduler::get_scheduler(), std::runtime_error);
 }
+
+// Tasks that are due at the same time are passed in a single batch.
+TEST(Scheduler, batch_consumer_receives_due_tasks_together) {
+    constexpr size_t taskCount = 100;
+
+    std::mutex mutex;
+    std::vector<size_t> batchSizes;
+    std::atomic<size_t> executed{0};
+
+    smack::Scheduler scheduler( [&]( std::vector<smack::THUNK>&& batch ){
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            batchSizes.push_back(batch.size());
+        }
+        for (auto& thunk : batch) {
+            thunk();
+        }
+    } );
+
+    auto target = std::chrono::system_clock::now() + 200ms;
+    for (size_t i = 0; i < taskCount; ++i) {
+        ASSERT_TRUE(
+            scheduler.scheduleAt(
+                [&executed](){ executed++; },
+                target
+            )
+        );
+    }
+
+    std::this_thread::sleep_for(500ms);
+
+    EXPECT_EQ(taskCount, executed.load());
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(1u, batchSizes.size());
+    EXPECT_EQ(taskCount, batchSizes[0]);
+}
+
+// get_scheduler() works for tasks passed in a batch.
+TEST(Scheduler, batch_consumer_get_scheduler) {
+    std::promise<smack::Scheduler*> result;
+    auto future = result.get_future();
+
+    smack::Scheduler scheduler( []( std::vector<smack::THUNK>&& batch ){
+        for (auto& thunk : batch) {
+            thunk();
+        }
+    } );
+
+    ASSERT_TRUE(
+        scheduler.schedule(
+            [&result](){
+                result.set_value(&smack::Scheduler::get_scheduler());
+            }
+        )
+    );
+
+    ASSERT_EQ(std::future_status::ready, future.wait_for(2s));
+    EXPECT_EQ(&scheduler, future.get());
+}
+
+// A thread pool can directly consume the batches of a scheduler.
+TEST(Scheduler, batch_consumer_with_pool) {
+    constexpr size_t taskCount = 50;
+
+    smack::ThreadPool pool{ 4 };
+    smack::Scheduler scheduler( [&pool]( std::vector<smack::THUNK>&& batch ){
+        pool.exec( std::move(batch) );
+    } );
+
+    std::atomic<size_t> executed{0};
+    auto target = std::chrono::system_clock::now() + 100ms;
+    for (size_t i = 0; i < taskCount; ++i) {
+        scheduler.scheduleAt( [&executed](){ executed++; }, target );
+    }
+
+    std::this_thread::sleep_for(400ms);
+
+    EXPECT_EQ(taskCount, executed.load());
+}
+
+// A task with a slack is executed together with a task that is due
+// within its tolerance window.
+TEST(Scheduler, slack_coalesces_tasks) {
+    std::mutex mutex;
+    std::vector<size_t> batchSizes;
+    std::atomic<size_t> executed{0};
+
+    smack::Scheduler scheduler( [&]( std::vector<smack::THUNK>&& batch ){
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            batchSizes.push_back(batch.size());
+        }
+        for (auto& thunk : batch) {
+            thunk();
+        }
+    } );
+
+    auto now = std::chrono::system_clock::now();
+
+    // Due at 100ms, may run until 400ms.
+    ASSERT_TRUE(
+        scheduler.scheduleAt( [&executed](){ executed++; }, now + 100ms, 300ms ) );
+    // Precise, due at 300ms.
+    ASSERT_TRUE(
+        scheduler.scheduleAt( [&executed](){ executed++; }, now + 300ms ) );
+
+    std::this_thread::sleep_for(200ms);
+    EXPECT_EQ(0u, executed.load());
+
+    std::this_thread::sleep_for(400ms);
+    EXPECT_EQ(2u, executed.load());
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(1u, batchSizes.size());
+    EXPECT_EQ(2u, batchSizes[0]);
+}
+
+// A task with a slack is executed within its tolerance window.
+TEST(Scheduler, slack_executes_within_window) {
+    smack::Scheduler scheduler;
+    std::promise<std::chrono::system_clock::time_point> executed_at;
+    auto future = executed_at.get_future();
+
+    auto scheduled_at = std::chrono::system_clock::now();
+    ASSERT_TRUE(
+        scheduler.scheduleIn(
+            [&executed_at](){ executed_at.set_value(std::chrono::system_clock::now()); },
+            100ms,
+            100ms
+        )
+    );
+
+    ASSERT_EQ(std::future_status::ready, future.wait_for(2s));
+    auto elapsed = future.get() - scheduled_at;
+    EXPECT_GE(elapsed, 100ms);
+    EXPECT_LT(elapsed, 400ms);
+}
+
+// A negative slack is rejected.
+TEST(Scheduler, slack_negative_throws) {
+    smack::Scheduler scheduler;
+
+    EXPECT_THROW(
+        scheduler.scheduleIn( [](){}, 100ms, -1ms ),
+        std::invalid_argument );
+    EXPECT_THROW(
+        scheduler.scheduleAt( [](){}, std::chrono::system_clock::now() + 1s, -1ms ),
+        std::invalid_argument );
+}
+
+// Tasks submitted concurrently from many threads are all executed.
+TEST(Scheduler, concurrent_producers) {
+    constexpr size_t producerCount = 8;
+    constexpr size_t taskCount = 1000;
+
+    std::atomic<size_t> executed{0};
+    smack::Scheduler scheduler( []( std::vector<smack::THUNK>&& batch ){
+        for (auto& thunk : batch) {
+            thunk();
+        }
+    } );
+
+    std::vector<std::thread> producers;
+    for (size_t i = 0; i < producerCount; ++i) {
+        producers.emplace_back([&scheduler, &executed, i](){
+            for (size_t j = 0; j < taskCount; ++j) {
+                scheduler.scheduleIn(
+                    [&executed](){ executed++; },
+                    smack::Duration( (i + j) % 20 ) );
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    for (int i = 0; i < 200 && executed < producerCount * taskCount; ++i) {
+        std::this_thread::sleep_for(10ms);
+    }
+
+    EXPECT_EQ(producerCount * taskCount, executed.load());
+}
+
+// Tasks that are due at the same time are executed in submission order.
+TEST(Scheduler, same_time_submission_order) {
+    std::vector<int> order;
+    smack::Scheduler scheduler( []( std::vector<smack::THUNK>&& batch ){
+        for (auto& thunk : batch) {
+            thunk();
+        }
+    } );
+
+    auto target = std::chrono::system_clock::now() + 100ms;
+    for (int i = 0; i < 10; ++i) {
+        scheduler.scheduleAt( [&order, i](){ order.push_back(i); }, target );
+    }
+
+    std::this_thread::sleep_for(300ms);
+    scheduler.stop();
+
+    EXPECT_EQ((std::vector<int>{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }), order);
+}
+
+// A scheduler on virtual time executes a cyclic task for a long period
+// without waiting.
+TEST(Scheduler, virtual_scheduleCyclic) {
+    smack::VirtualClock clock;
+    smack::Scheduler scheduler{ clock };
+
+    int count = 0;
+    ASSERT_TRUE(
+        scheduler.scheduleCyclic(
+            [&count](){ count++; },
+            1min
+        )
+    );
+
+    // The first run is immediate, then one run per minute.
+    clock.advance(60min);
+
+    EXPECT_EQ(61, count);
+    EXPECT_EQ(smack::TimePoint{} + 60min, scheduler.now());
+}
+
+// Tasks on virtual time are executed in time order with the clock set to
+// their due time.
+TEST(Scheduler, virtual_time_order) {
+    smack::VirtualClock clock;
+    smack::Scheduler scheduler{ clock };
+
+    std::vector<std::pair<int, smack::TimePoint>> executed;
+    auto record = [&executed, &clock]( int id ) {
+        return [&executed, &clock, id](){ executed.emplace_back(id, clock.now()); };
+    };
+
+    auto start = clock.now();
+    scheduler.scheduleIn( record(3), 30s );
+    scheduler.scheduleIn( record(1), 10s );
+    scheduler.scheduleIn( record(4), 1h );
+    scheduler.scheduleIn( record(2), 20s );
+
+    clock.advance(30s);
+
+    ASSERT_EQ(3u, executed.size());
+    EXPECT_EQ(std::make_pair(1, start + 10s), executed[0]);
+    EXPECT_EQ(std::make_pair(2, start + 20s), executed[1]);
+    EXPECT_EQ(std::make_pair(3, start + 30s), executed[2]);
+
+    clock.advance(1h);
+
+    ASSERT_EQ(4u, executed.size());
+    EXPECT_EQ(std::make_pair(4, start + 1h), executed[3]);
+}
+
+// Tasks scheduled by tasks on virtual time are executed in the same
+// advance.
+TEST(Scheduler, virtual_chained) {
+    smack::VirtualClock clock;
+    smack::Scheduler scheduler{ clock };
+
+    std::vector<int> counts;
+    std::function<void(int)> chain = [&]( int count ) {
+        counts.push_back(count);
+        if (count > 0) {
+            smack::Scheduler::get_scheduler().scheduleIn(
+                [&chain, count](){ chain(count - 1); },
+                250ms );
+        }
+    };
+
+    scheduler.schedule( [&chain](){ chain(4); } );
+
+    clock.advance(1s);
+
+    EXPECT_EQ((std::vector<int>{ 4, 3, 2, 1, 0 }), counts);
+}
+
+// A stopped scheduler on virtual time executes no tasks.
+TEST(Scheduler, virtual_stop) {
+    smack::VirtualClock clock;
+    smack::Scheduler scheduler{ clock };
+
+    int count = 0;
+    scheduler.scheduleIn( [&count](){ count++; }, 1s );
+    scheduler.stop();
+
+    clock.advance(2s);
+
+    EXPECT_EQ(0, count);
+    EXPECT_FALSE(scheduler.schedule( [](){} ));
+}
+
+// The statistics count pending and fired tasks.
+TEST(Scheduler, statistics_counts) {
+    smack::VirtualClock clock;
+    smack::Scheduler scheduler{ clock };
+
+    for (int i = 0; i < 10; ++i) {
+        scheduler.scheduleIn( [](){}, smack::Duration( i * 100 ) );
+    }
+
+    auto before = scheduler.statistics();
+    EXPECT_EQ(10u, before.pending);
+    EXPECT_EQ(0u, before.fired);
+
+    clock.advance(450ms);
+
+    auto after = scheduler.statistics();
+    EXPECT_EQ(5u, after.pending);
+    EXPECT_EQ(5u, after.fired);
+    EXPECT_EQ(5u, after.batches);
+    // On virtual time no task is late.
+    EXPECT_EQ(std::chrono::microseconds{0}, after.latenessPercentile(0.99));
+    EXPECT_EQ(5u, after.latenessHistogram.count());
+    EXPECT_EQ(0u, after.latenessHistogram.max());
+    EXPECT_LE(0.0, after.firesPerSecond(before));
+}
+
+// The statistics record the lateness of tasks on real time.
+TEST(Scheduler, statistics_lateness) {
+    smack::Scheduler scheduler( []( std::vector<smack::THUNK>&& batch ){
+        for (auto& thunk : batch) {
+            thunk();
+        }
+    } );
+
+    std::promise<void> done;
+    auto future = done.get_future();
+    scheduler.scheduleIn( [&done](){ done.set_value(); }, 10ms );
+
+    ASSERT_EQ(std::future_status::ready, future.wait_for(2s));
+
+    auto statistics = scheduler.statistics();
+    EXPECT_EQ(1u, statistics.fired);
+    EXPECT_EQ(0u, statistics.pending);
+    EXPECT_EQ(1u, statistics.latenessHistogram.count());
+    EXPECT_GE(1s, statistics.latenessPercentile(1.0));
+}
+
+// A cyclic task keeps a single pending entry that is re-armed after
+// each run.
+TEST(Scheduler, cyclic_rearms_single_entry) {
+    smack::VirtualClock clock;
+    smack::Scheduler scheduler{ clock };
+
+    int count = 0;
+    ASSERT_TRUE(
+        scheduler.scheduleCyclic( [&count](){ count++; }, 1ms ) );
+
+    clock.advance(1s);
+
+    EXPECT_EQ(1001, count);
+    EXPECT_EQ(1u, scheduler.statistics().pending);
+}
+
+// A cycle re-arms the task without allocation.
+TEST(Scheduler, cyclic_does_not_allocate) {
+    smack::VirtualClock clock;
+    smack::Scheduler scheduler{ clock };
+
+    int count = 0;
+    ASSERT_TRUE(
+        scheduler.scheduleCyclic( [&count](){ count++; }, 1ms ) );
+
+    // Reserves the batch.
+    clock.advance(1ms);
+
+    auto before = smack::util::AllocationCounter::current();
+    clock.advance(100ms);
+    auto after = smack::util::AllocationCounter::current();
+
+    EXPECT_EQ(102, count);
+    EXPECT_EQ(0u, after.allocations - before.allocations);
+}
+
+// A cyclic task that throws is not executed again.
+TEST(Scheduler, cyclic_stops_on_exception) {
+    smack::VirtualClock clock;
+    smack::Scheduler scheduler{ clock };
+
+    int count = 0;
+    ASSERT_TRUE(
+        scheduler.scheduleCyclic(
+            [&count](){
+                if (++count == 3) {
+                    throw std::runtime_error("stop");
+                }
+            },
+            1s ) );
+
+    EXPECT_THROW(clock.advance(10s), std::runtime_error);
+    EXPECT_EQ(3, count);
+
+    clock.advance(10s);
+    EXPECT_EQ(3, count);
+    EXPECT_EQ(0u, scheduler.statistics().pending);
+}
+
+// A cyclic task left in the batch by a throwing consumer does not block
+// the destructor.
+TEST(Scheduler, cyclic_destroy_after_consumer_throws) {
+    smack::VirtualClock clock;
+    int count = 0;
+
+    {
+        smack::Scheduler scheduler{ clock };
+
+        ASSERT_TRUE(scheduler.scheduleCyclic(
+            [](){ throw std::runtime_error("stop"); }, 1s ));
+        ASSERT_TRUE(scheduler.scheduleCyclic( [&count](){ count++; }, 1s ));
+
+        EXPECT_THROW(clock.advance(0s), std::runtime_error);
+    }
+
+    EXPECT_EQ(0, count);
+}
+
+// The destructor waits for cyclic tasks that were passed to an
+// asynchronous consumer but have not started yet.
+TEST(Scheduler, cyclic_destroy_waits_for_consumer) {
+    smack::VirtualClock clock;
+    std::atomic<bool> started = false;
+    std::atomic<int> count = 0;
+
+    {
+        smack::Scheduler scheduler{ clock, [&started](std::vector<smack::THUNK>&& batch) {
+            std::thread( [&started, batch = std::move(batch)]() {
+                std::this_thread::sleep_for(100ms);
+                started = true;
+                for (auto& thunk : batch) {
+                    thunk();
+                }
+            } ).detach();
+        } };
+
+        ASSERT_TRUE(scheduler.scheduleCyclic( [&count](){ count++; }, 1s ));
+
+        clock.advance(1s);
+    }
+
+    EXPECT_TRUE(started);
+    // Stopped before the task started.
+    EXPECT_EQ(0, count.load());
+}
+
+// get_scheduler() works in cyclic tasks.
+TEST(Scheduler, cyclic_get_scheduler) {
+    smack::VirtualClock clock;
+    smack::Scheduler scheduler{ clock };
+
+    smack::Scheduler* result = nullptr;
+    ASSERT_TRUE(
+        scheduler.scheduleCyclic(
+            [&result](){ result = &smack::Scheduler::get_scheduler(); },
+            1s ) );
+
+    clock.advance(1s);
+
+    EXPECT_EQ(&scheduler, result);
+}
+
+// A calendar task is only stepped at the selected times.
+TEST(Scheduler, cron_virtual) {
+    // 1970-01-01T00:00:00 UTC
+    smack::VirtualClock clock;
+    smack::Scheduler scheduler{ clock };
+
+    std::vector<smack::TimePoint> fired;
+    ASSERT_TRUE(
+        scheduler.scheduleCron(
+            [&fired, &clock](){ fired.push_back(clock.now()); },
+            smack::CronExpression{ "0/15 2 * * *" } ) );
+
+    clock.advance(std::chrono::hours{48});
+
+    ASSERT_EQ(8u, fired.size());
+    EXPECT_EQ(smack::TimePoint{} + 2h, fired[0]);
+    EXPECT_EQ(smack::TimePoint{} + 2h + 45min, fired[3]);
+    EXPECT_EQ(smack::TimePoint{} + 26h, fired[4]);
+    EXPECT_EQ(8u, scheduler.statistics().fired);
+    EXPECT_EQ(1u, scheduler.statistics().pending);
+}
+
+// A calendar expression without a future time is not scheduled.
+TEST(Scheduler, cron_never_returns_false) {
+    smack::VirtualClock clock;
+    smack::Scheduler scheduler{ clock };
+
+    EXPECT_FALSE(
+        scheduler.scheduleCron(
+            [](){},
+            smack::CronExpression{ "0 0 30 2 *" } ) );
+}
+
+// A draining stop executes the tasks due until the deadline in one batch.
+TEST(Scheduler, stop_drain_until_deadline) {
+    smack::VirtualClock clock;
+
+    size_t batchSize = 0;
+    smack::Scheduler scheduler{ clock, [&batchSize](std::vector<smack::THUNK>&& batch) {
+        batchSize = batch.size();
+        for (auto& thunk : batch) {
+            thunk();
+        }
+    } };
+
+    std::vector<int> fired;
+    int cyclic = 0;
+    scheduler.scheduleIn( [&fired](){ fired.push_back(5); }, 5s );
+    scheduler.scheduleIn( [&fired](){ fired.push_back(1); }, 1s );
+    scheduler.scheduleIn( [&fired](){ fired.push_back(10); }, 10s );
+    scheduler.scheduleCyclic( [&cyclic](){ cyclic++; }, 2s, clock.now() + 3s );
+
+    scheduler.stop( smack::Scheduler::Drain::UntilDeadline, 6s );
+
+    EXPECT_EQ(3u, batchSize);
+    EXPECT_EQ((std::vector<int>{ 1, 5 }), fired);
+    EXPECT_EQ(1, cyclic);
+    EXPECT_EQ(smack::TimePoint{}, clock.now());
+    EXPECT_EQ(1u, scheduler.statistics().batches);
+    EXPECT_EQ(1u, scheduler.statistics().pending);
+
+    // Stopped, nothing else is executed.
+    clock.advance(1min);
+    EXPECT_EQ(1, cyclic);
+    EXPECT_EQ(2u, fired.size());
+    EXPECT_FALSE(scheduler.schedule( [](){} ));
+}
+
+// A draining stop executes a task with slack that is due before the
+// deadline, even if a task due after the deadline has an earlier
+// latest time.
+TEST(Scheduler, stop_drain_slack) {
+    smack::VirtualClock clock;
+    std::vector<int> fired;
+    smack::Scheduler scheduler{ clock, [](std::vector<smack::THUNK>&& batch) {
+        for (auto& thunk : batch) {
+            thunk();
+        }
+    } };
+
+    scheduler.scheduleIn( [&fired](){ fired.push_back(1); }, 100ms, 10s );
+    scheduler.scheduleIn( [&fired](){ fired.push_back(2); }, 5s );
+
+    scheduler.stop( smack::Scheduler::Drain::UntilDeadline, 1s );
+
+    EXPECT_EQ((std::vector<int>{ 1 }), fired);
+    EXPECT_EQ(1u, scheduler.statistics().pending);
+}
+
+// A draining stop does not wait for the due time of the tasks.
+TEST(Scheduler, stop_drain_realtime) {
+    std::atomic<int> count = 0;
+    smack::Scheduler scheduler{ [](smack::THUNK thunk) { thunk(); } };
+
+    scheduler.scheduleIn( [&count](){ count++; }, 1h );
+    scheduler.scheduleIn( [&count](){ count++; }, 3h );
+
+    auto start = std::chrono::steady_clock::now();
+    scheduler.stop( smack::Scheduler::Drain::UntilDeadline, 2h );
+
+    EXPECT_EQ(1, count);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 1s);
+}
+
+// Tasks that are due after the dispatcher's next wake-up do not wake it.
+TEST(Scheduler, later_tasks_do_not_wake_dispatcher) {
+    std::atomic<int> count = 0;
+    smack::Scheduler scheduler{ [](smack::THUNK thunk) { thunk(); } };
+
+    scheduler.scheduleIn( [&count](){ count++; }, 1h );
+    std::this_thread::sleep_for(50ms);
+
+    auto before = scheduler.statistics().wakeups;
+    for (int i = 0; i < 1000; ++i) {
+        scheduler.scheduleIn( [&count](){ count++; }, 2h );
+    }
+    std::this_thread::sleep_for(50ms);
+    EXPECT_EQ(before, scheduler.statistics().wakeups);
+
+    // An earlier task wakes the dispatcher.
+    scheduler.scheduleIn( [&count](){ count++; }, 10ms );
+    std::this_thread::sleep_for(200ms);
+    EXPECT_EQ(1, count);
+    EXPECT_EQ(1001u, scheduler.statistics().pending);
+}
@@ -0,0 +1,137 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Tests.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include <smack_sharded_scheduler.h>
+
+TEST(ShardedScheduler, zeroShards_throws) {
+    EXPECT_THROW(
+        smack::ShardedScheduler{ 0 },
+        std::invalid_argument );
+}
+
+TEST(ShardedScheduler, size) {
+    smack::ShardedScheduler scheduler{ 3 };
+
+    EXPECT_EQ(3u, scheduler.size());
+}
+
+// Tasks scheduled from many threads are executed on all shards.
+TEST(ShardedScheduler, concurrent_producers) {
+    constexpr size_t producerCount = 8;
+    constexpr size_t taskCount = 500;
+
+    std::atomic<size_t> executed{0};
+    smack::ShardedScheduler scheduler(
+        []( smack::THUNK thunk ){ thunk(); },
+        4 );
+
+    std::vector<std::thread> producers;
+    for (size_t i = 0; i < producerCount; ++i) {
+        producers.emplace_back([&scheduler, &executed](){
+            for (size_t j = 0; j < taskCount; ++j) {
+                scheduler.scheduleIn(
+                    [&executed](){ executed++; },
+                    smack::Duration( j % 10 ) );
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    for (int i = 0; i < 200 && executed < producerCount * taskCount; ++i) {
+        std::this_thread::sleep_for(10ms);
+    }
+
+    EXPECT_EQ(producerCount * taskCount, executed.load());
+}
+
+// Tasks with the same key are executed by the same shard.
+TEST(ShardedScheduler, key_selects_shard) {
+    smack::ShardedScheduler scheduler{ 4 };
+
+    std::promise<smack::Scheduler*> result;
+    auto future = result.get_future();
+
+    ASSERT_TRUE(
+        scheduler.scheduleIn(
+            42,
+            [&result](){
+                result.set_value(&smack::Scheduler::get_scheduler());
+            },
+            10ms
+        )
+    );
+
+    ASSERT_EQ(std::future_status::ready, future.wait_for(2s));
+    EXPECT_EQ(&scheduler.shardFor(42), future.get());
+}
+
+TEST(ShardedScheduler, scheduleCyclic) {
+    std::atomic<int> count{0};
+    smack::ShardedScheduler scheduler{ 2 };
+
+    ASSERT_TRUE(
+        scheduler.scheduleCyclic(
+            [&count](){ count++; },
+            50ms
+        )
+    );
+
+    std::this_thread::sleep_for(300ms);
+
+    EXPECT_GE(count.load(), 3);
+}
+
+TEST(ShardedScheduler, schedule_returns_false_after_stop) {
+    smack::ShardedScheduler scheduler{ 2 };
+    scheduler.stop();
+
+    EXPECT_FALSE(
+        scheduler.schedule(
+            [](){ /* must not run */ }
+        )
+    );
+    EXPECT_FALSE(
+        scheduler.scheduleIn(
+            7,
+            [](){ /* must not run */ },
+            10ms
+        )
+    );
+}
+
+// The statistics are summed over all shards.
+TEST(ShardedScheduler, statistics) {
+    smack::ShardedScheduler scheduler{ 4 };
+
+    for (size_t key = 0; key < 8; ++key) {
+        ASSERT_TRUE(scheduler.scheduleIn( key, [](){}, 1h ));
+    }
+
+    auto statistics = scheduler.statistics();
+    EXPECT_EQ(8u, statistics.pending);
+    EXPECT_EQ(0u, statistics.fired);
+    EXPECT_EQ(0u, statistics.latenessHistogram.count());
+}
+
+TEST(ShardedScheduler, now) {
+    smack::ShardedScheduler scheduler{ 2 };
+
+    auto before = scheduler.shard(0).now();
+    auto now = scheduler.now();
+
+    EXPECT_LE(before, now);
+    EXPECT_LE(now, scheduler.shard(1).now());
+}
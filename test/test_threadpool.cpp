@@ -7,6 +7,9 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <vector>
+
 #include <smack_threadpool.h>
 #include <smack_util_time_probe.hpp>
 
@@ -145,3 +148,33 @@ TEST(TimeProbe, research)
 
 //     return 0;
 // }
+
+TEST(ThreadPool, execBatch) {
+    std::atomic<size_t> count{0};
+
+    {
+        smack::ThreadPool pool{ 3 };
+
+        std::vector<smack::THUNK> tasks;
+        for (int i = 0; i < 10; ++i) {
+            tasks.emplace_back([&count]{ count++; });
+        }
+
+        pool.exec(std::move(tasks));
+    }
+
+    ASSERT_EQ(10u, count.load());
+}
+
+TEST(ThreadPool, execBatch_stopped) {
+    smack::ThreadPool pool{ 1 };
+    pool.stop();
+
+    std::vector<smack::THUNK> tasks;
+    tasks.emplace_back([]{});
+
+    ASSERT_THROW(
+        pool.exec(std::move(tasks)),
+        std::runtime_error
+    );
+}
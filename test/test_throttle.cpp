@@ -0,0 +1,152 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Tests.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <smack_clock.h>
+#include <smack_scheduler.h>
+#include <smack_throttle.h>
+
+TEST(RateLimiter, invalid_arguments) {
+    smack::VirtualClock clock;
+    smack::Scheduler scheduler{ clock };
+
+    EXPECT_THROW(smack::RateLimiter(scheduler, 0.0), std::invalid_argument);
+    EXPECT_THROW(smack::RateLimiter(scheduler, 1.0, 0.5), std::invalid_argument);
+}
+
+TEST(RateLimiter, tryAcquire) {
+    smack::VirtualClock clock;
+    smack::Scheduler scheduler{ clock };
+    smack::RateLimiter limiter{ scheduler, 10.0, 2.0 };
+
+    EXPECT_TRUE(limiter.tryAcquire());
+    EXPECT_TRUE(limiter.tryAcquire());
+    EXPECT_FALSE(limiter.tryAcquire());
+
+    clock.advance(100ms);
+
+    EXPECT_TRUE(limiter.tryAcquire());
+    EXPECT_FALSE(limiter.tryAcquire());
+}
+
+// Waiting callers are resumed by the scheduler in call order at the
+// token rate.
+TEST(RateLimiter, acquire_resumes_waiters) {
+    smack::VirtualClock clock;
+    smack::Scheduler scheduler{ clock };
+    smack::RateLimiter limiter{ scheduler, 10.0 };
+
+    std::vector<std::pair<int, smack::TimePoint>> executed;
+    auto start = clock.now();
+
+    for (int i = 0; i < 4; ++i) {
+        limiter.acquire( [&executed, &clock, i](){ executed.emplace_back(i, clock.now()); } );
+    }
+
+    // The first is executed directly.
+    ASSERT_EQ(1u, executed.size());
+    EXPECT_EQ(3u, limiter.waiting());
+    // A single timer for all waiters.
+    EXPECT_EQ(1u, scheduler.statistics().pending);
+
+    clock.advance(1s);
+
+    ASSERT_EQ(4u, executed.size());
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(i, executed[i].first);
+        EXPECT_EQ(start + i * 100ms, executed[i].second);
+    }
+    EXPECT_EQ(0u, limiter.waiting());
+}
+
+TEST(RateLimiter, destroyed_drops_waiters) {
+    smack::VirtualClock clock;
+    smack::Scheduler scheduler{ clock };
+
+    int count = 0;
+    {
+        smack::RateLimiter limiter{ scheduler, 1.0 };
+        limiter.acquire( [&count](){ count++; } );
+        limiter.acquire( [&count](){ count++; } );
+    }
+
+    clock.advance(5s);
+
+    EXPECT_EQ(1, count);
+}
+
+// The first call is executed directly, the last call within the
+// interval at its end.
+TEST(Throttle, leading_and_trailing) {
+    smack::VirtualClock clock;
+    smack::Scheduler scheduler{ clock };
+    smack::Throttle throttle{ scheduler, 100ms };
+
+    std::vector<int> executed;
+
+    throttle.call( [&executed](){ executed.push_back(1); } );
+    throttle.call( [&executed](){ executed.push_back(2); } );
+    throttle.call( [&executed](){ executed.push_back(3); } );
+
+    EXPECT_EQ((std::vector<int>{ 1 }), executed);
+
+    clock.advance(100ms);
+
+    EXPECT_EQ((std::vector<int>{ 1, 3 }), executed);
+
+    // Within the interval of the trailing call.
+    throttle.call( [&executed](){ executed.push_back(4); } );
+    EXPECT_EQ((std::vector<int>{ 1, 3 }), executed);
+
+    clock.advance(100ms);
+    EXPECT_EQ((std::vector<int>{ 1, 3, 4 }), executed);
+
+    clock.advance(1s);
+    throttle.call( [&executed](){ executed.push_back(5); } );
+    EXPECT_EQ((std::vector<int>{ 1, 3, 4, 5 }), executed);
+}
+
+// Only the last call is executed after the quiet period.
+TEST(Debounce, last_call_after_quiet_period) {
+    smack::VirtualClock clock;
+    smack::Scheduler scheduler{ clock };
+    smack::Debounce debounce{ scheduler, 100ms };
+
+    std::vector<std::pair<int, smack::TimePoint>> executed;
+    auto start = clock.now();
+
+    for (int i = 0; i < 5; ++i) {
+        debounce.call( [&executed, &clock, i](){ executed.emplace_back(i, clock.now()); } );
+        clock.advance(50ms);
+    }
+
+    EXPECT_TRUE(executed.empty());
+
+    clock.advance(1s);
+
+    ASSERT_EQ(1u, executed.size());
+    EXPECT_EQ(4, executed[0].first);
+    EXPECT_EQ(start + 300ms, executed[0].second);
+}
+
+TEST(Debounce, destroyed_drops_call) {
+    smack::VirtualClock clock;
+    smack::Scheduler scheduler{ clock };
+
+    int count = 0;
+    {
+        smack::Debounce debounce{ scheduler, 100ms };
+        debounce.call( [&count](){ count++; } );
+    }
+
+    clock.advance(1s);
+
+    EXPECT_EQ(0, count);
+}
@@ -7,7 +7,11 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "smack_util_time_probe.hpp"
 
@@ -26,3 +30,140 @@ TEST(StrCompare, CStrEqual) {
 TEST(StrCompare, CStrNotEqual) {
     EXPECT_STRNE(expectVal, actualValFalse);
 }
+
+TEST(TimeProbe, evaluate) {
+  std::vector<double> samples;
+  for (int i = 100; i >= 1; i--)
+    samples.push_back(i);
+  // An outlier.
+  samples.push_back(1000.0);
+
+  auto result = smack::util::TimeProbe::evaluate(samples);
+
+  EXPECT_EQ(101u, result.samples);
+  EXPECT_DOUBLE_EQ(1.0, result.min);
+  EXPECT_DOUBLE_EQ(1000.0, result.max);
+  EXPECT_DOUBLE_EQ((5050.0 + 1000.0) / 101, result.mean);
+  EXPECT_DOUBLE_EQ(51.0, result.median);
+  EXPECT_DOUBLE_EQ(91.0, result.p90);
+  EXPECT_DOUBLE_EQ(100.0, result.p99);
+  EXPECT_DOUBLE_EQ(1000.0, result.p999);
+  EXPECT_EQ(1u, result.outliers);
+  EXPECT_GT(result.stddev, 0.0);
+  // Sorted in place.
+  EXPECT_TRUE(std::is_sorted(samples.begin(), samples.end()));
+}
+
+TEST(TimeProbe, evaluate_empty) {
+  std::vector<double> samples;
+
+  auto result = smack::util::TimeProbe::evaluate(samples);
+
+  EXPECT_EQ(0u, result.samples);
+}
+
+TEST(TimeProbe, profile_statistics) {
+  std::vector<double> samples;
+  int count = 0;
+
+  auto result = smack::util::TimeProbe::profile_statistics(
+    50, [&count]() { count++; }, samples);
+
+  EXPECT_EQ(50, count);
+  EXPECT_EQ(50u, result.samples);
+  EXPECT_EQ(50u, samples.size());
+  EXPECT_LE(result.min, result.median);
+  EXPECT_LE(result.median, result.p90);
+  EXPECT_LE(result.p90, result.p99);
+  EXPECT_LE(result.p99, result.max);
+}
+
+TEST(TimeProbe, tsc_clock) {
+  if (!smack::util::TscClock::available())
+    GTEST_SKIP() << "No invariant TSC.";
+
+  auto start = smack::util::TscClock::start();
+  auto end = smack::util::TscClock::stop();
+
+  EXPECT_LE(start, end);
+  // More than 100MHz.
+  EXPECT_GT(smack::util::TscClock::ticks_per_second(), 1e8);
+}
+
+TEST(TimeProbe, profile_statistics_tsc) {
+  auto result = smack::util::TimeProbe::profile_statistics(
+    50, []() {}, smack::util::ProfileClock::Tsc);
+
+  EXPECT_EQ(50u, result.samples);
+
+  if (smack::util::TscClock::available()) {
+    EXPECT_DOUBLE_EQ(smack::util::TscClock::ticks_per_second(), result.ticksPerSecond);
+    EXPECT_GE(result.cycles(result.median), 0.0);
+  }
+  else {
+    EXPECT_EQ(0.0, result.ticksPerSecond);
+  }
+}
+
+TEST(TimeProbe, perf_counters) {
+  smack::util::PerfCounters counters;
+
+  if (!counters.available()) {
+    EXPECT_FALSE(counters.read().valid);
+    GTEST_SKIP() << "No access to perf events.";
+  }
+
+  counters.start();
+  volatile int sum = 0;
+  for (int i = 0; i < 100000; i++)
+    sum = sum + i;
+  counters.stop();
+
+  auto values = counters.read();
+  EXPECT_TRUE(values.valid);
+  EXPECT_GT(values.instructions, 100000.0);
+  EXPECT_GT(values.ipc(), 0.0);
+}
+
+TEST(TimeProbe, profile_statistics_counters) {
+  auto result = smack::util::TimeProbe::profile_statistics(
+    50,
+    []() {},
+    smack::util::ProfileClock::Chrono,
+    smack::util::ProfileCounters::Hardware);
+
+  EXPECT_EQ(50u, result.samples);
+  EXPECT_EQ(smack::util::PerfCounters{}.available(), result.counters.valid);
+  if (result.counters.valid) {
+    EXPECT_GT(result.counters.instructions, 0.0);
+  }
+}
+
+TEST(TimeProbe, default_threads) {
+  auto threads = smack::util::TimeProbe::default_threads();
+
+  ASSERT_FALSE(threads.empty());
+  EXPECT_EQ(1u, threads.front());
+  EXPECT_EQ(std::max(1u, std::thread::hardware_concurrency()), threads.back());
+  EXPECT_TRUE(std::is_sorted(threads.begin(), threads.end()));
+}
+
+TEST(TimeProbe, profile_scaling) {
+  std::atomic<int> count{ 0 };
+
+  auto results = smack::util::TimeProbe::profile_scaling(
+    100, [&count]() { count++; }, { 1, 0, 3 });
+
+  // The zero thread count is skipped.
+  ASSERT_EQ(2u, results.size());
+  EXPECT_EQ(400, count.load());
+
+  EXPECT_EQ(1u, results[0].threads);
+  EXPECT_EQ(3u, results[1].threads);
+  EXPECT_EQ(100u, results[1].times);
+  EXPECT_DOUBLE_EQ(1.0, results[0].efficiency);
+  for (const auto& r : results) {
+    EXPECT_GT(r.seconds, 0.0);
+    EXPECT_NEAR(r.threads * 100 / r.seconds, r.throughput, 1e-6 * r.throughput);
+  }
+}
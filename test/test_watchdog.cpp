@@ -0,0 +1,178 @@
+/* Smack C++ @ https://github.com/smacklib/dev_smack_cpp
+ *
+ * Tests.
+ *
+ * Copyright © 2026 Michael Binz
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <future>
+#include <thread>
+
+#include <smack_clock.h>
+#include <smack_scheduler.h>
+#include <smack_threadpool.h>
+#include <smack_watchdog.h>
+
+// A task that finishes in time is disarmed and its timeout callback is
+// not called.
+TEST(Watchdog, finished_in_time) {
+    smack::VirtualClock clock;
+    smack::Scheduler scheduler{ clock };
+    std::atomic<int> timeouts{0};
+
+    {
+        smack::ThreadPool pool{ 2 };
+        smack::Watchdog watchdog{ pool, scheduler, 1s };
+
+        watchdog.exec(
+            []( const smack::Watchdog::Cancellation& ){},
+            [&timeouts](){ timeouts++; } );
+
+        pool.stop();
+
+        EXPECT_EQ(0u, watchdog.armed());
+    }
+
+    clock.advance(2s);
+
+    EXPECT_EQ(0, timeouts.load());
+}
+
+// Destroying the watchdog stops the timeout handling of running tasks.
+TEST(Watchdog, destroyed_before_timeout) {
+    smack::VirtualClock clock;
+    smack::Scheduler scheduler{ clock };
+    smack::ThreadPool pool{ 2 };
+
+    std::promise<void> started;
+    std::atomic<bool> release{ false };
+    std::atomic<bool> cancelled{ false };
+    std::atomic<int> timeouts{0};
+
+    {
+        smack::Watchdog watchdog{ pool, scheduler, 1s };
+
+        watchdog.exec(
+            [&started, &release, &cancelled]( const smack::Watchdog::Cancellation& cancellation ){
+                started.set_value();
+                while (!release) {
+                    std::this_thread::sleep_for(1ms);
+                }
+                cancelled = cancellation.isCancelled();
+            },
+            [&timeouts](){ timeouts++; } );
+
+        started.get_future().wait();
+    }
+
+    clock.advance(2s);
+    release = true;
+    pool.stop();
+
+    EXPECT_EQ(0, timeouts.load());
+    EXPECT_FALSE(cancelled);
+}
+
+// A task that overruns its timeout is cancelled and its timeout callback
+// is called.
+TEST(Watchdog, timeout_cancels) {
+    smack::VirtualClock clock;
+    smack::Scheduler scheduler{ clock };
+    smack::ThreadPool pool{ 2 };
+    smack::Watchdog watchdog{ pool, scheduler, 1s };
+
+    std::promise<void> started;
+    std::promise<bool> finished;
+    std::atomic<int> timeouts{0};
+
+    watchdog.exec(
+        [&started, &finished]( const smack::Watchdog::Cancellation& cancellation ){
+            started.set_value();
+            while (!cancellation.isCancelled()) {
+                std::this_thread::sleep_for(1ms);
+            }
+            finished.set_value(true);
+        },
+        [&timeouts](){ timeouts++; } );
+
+    started.get_future().wait();
+    EXPECT_EQ(1u, watchdog.armed());
+
+    clock.advance(999ms);
+    EXPECT_EQ(0, timeouts.load());
+
+    clock.advance(1ms);
+    EXPECT_EQ(1, timeouts.load());
+
+    auto future = finished.get_future();
+    ASSERT_EQ(std::future_status::ready, future.wait_for(2s));
+    EXPECT_TRUE(future.get());
+    EXPECT_EQ(0u, watchdog.armed());
+}
+
+// Many tasks share a single timer.
+TEST(Watchdog, shared_timer) {
+    smack::VirtualClock clock;
+    smack::Scheduler scheduler{ clock };
+    smack::ThreadPool pool{ 1 };
+    smack::Watchdog watchdog{ pool, scheduler, 1s };
+
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::atomic<int> timeouts{0};
+
+    for (int i = 0; i < 10; ++i) {
+        watchdog.exec(
+            [released]( const smack::Watchdog::Cancellation& ){ released.wait(); },
+            [&timeouts](){ timeouts++; } );
+        clock.advance(100ms);
+    }
+
+    // The first deadline passed with the last advance.
+    EXPECT_EQ(1, timeouts.load());
+    EXPECT_EQ(1u, scheduler.statistics().pending);
+
+    clock.advance(500ms);
+    EXPECT_EQ(6, timeouts.load());
+
+    clock.advance(500ms);
+    EXPECT_EQ(10, timeouts.load());
+
+    release.set_value();
+    pool.stop();
+    EXPECT_EQ(0u, scheduler.statistics().pending);
+}
+
+// A watch reused after a timeout starts out not cancelled.
+TEST(Watchdog, reused_after_timeout) {
+    smack::VirtualClock clock;
+    smack::Scheduler scheduler{ clock };
+    smack::ThreadPool pool{ 1 };
+    smack::Watchdog watchdog{ pool, scheduler, 1s };
+
+    std::promise<void> release;
+    auto released = release.get_future().share();
+
+    watchdog.exec(
+        [released]( const smack::Watchdog::Cancellation& ){ released.wait(); } );
+    clock.advance(1s);
+    release.set_value();
+    // Lets the first task finish and recycle its watch.
+    std::this_thread::sleep_for(100ms);
+
+    std::promise<bool> cancelled;
+    watchdog.exec(
+        [&cancelled]( const smack::Watchdog::Cancellation& cancellation ){
+            cancelled.set_value(cancellation.isCancelled());
+        } );
+
+    auto future = cancelled.get_future();
+    ASSERT_EQ(std::future_status::ready, future.wait_for(2s));
+    EXPECT_FALSE(future.get());
+
+    pool.stop();
+    EXPECT_EQ(0u, watchdog.armed());
+}